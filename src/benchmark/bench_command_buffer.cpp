@@ -0,0 +1,82 @@
+// Benchmark command_buffer
+// - Measures recording of spawn and destroy commands from several threads and applying them at the sync point
+// - Compares one vector guarded by a mutex with CommandBuffer, where every thread records into its own buffer
+// - Each thread count from 1 up to the number of cores (at least 4) is reported
+// - Checks that every recorded command is applied exactly once
+// - Optional argument is the number of commands per frame (default 100000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+#include "benchmark.h"
+#include "command_buffer.h"
+
+const int FRAMES = 20;
+
+// Same size as the scene commands, a pointer to spawn and one to destroy
+struct BenchCommand {
+  void *spawn;
+  size_t destroy;
+};
+
+// Runs record(thread, begin, end) for count commands split between threads, returns seconds
+template<typename Record>
+static double RecordFrame(unsigned int threads, size_t count, Record record) {
+  Timer timer;
+  std::vector<std::thread> workers;
+  for (unsigned int t = 0; t < threads; t++)
+    workers.emplace_back(record, count * t / threads, count * (t + 1) / threads);
+  for (auto &worker : workers) worker.join();
+  return timer.Elapsed();
+}
+
+bool BenchmarkCommandBuffer(const std::vector<std::string> &args) {
+  int count = args.empty() ? 100000 : atoi(args[0].c_str());
+  if (count <= 0) count = 100000;
+
+  unsigned int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  printf("%d commands per frame\n", count);
+  printf("%-8s %18s %18s %12s %10s\n", "threads", "mutex record [ms]", "buffer record [ms]", "apply [ms]", "speed-up");
+
+  std::vector<uint32_t> applied((size_t) count);
+  for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+    double mutex_time = 0.0, buffer_time = 0.0, apply_time = 0.0;
+
+    std::mutex mutex;
+    std::vector<BenchCommand> shared;
+    CommandBuffer<BenchCommand> buffer;
+    std::fill(applied.begin(), applied.end(), 0);
+
+    for (int frame = 0; frame < FRAMES; frame++) {
+      mutex_time += RecordFrame(threads, (size_t) count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          std::lock_guard<std::mutex> lock(mutex);
+          shared.push_back({nullptr, i});
+        }
+      });
+      shared.clear();
+
+      // Threads are new every frame, so each one registers its buffer once per frame as well
+      buffer_time += RecordFrame(threads, (size_t) count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) buffer.Record({nullptr, i});
+      });
+
+      Timer timer;
+      buffer.Apply([&](const BenchCommand &command) { applied[command.destroy]++; });
+      apply_time += timer.Elapsed();
+    }
+
+    printf("%-8u %18.3f %18.3f %12.3f %9.2fx\n", threads, mutex_time * 1000.0 / FRAMES,
+           buffer_time * 1000.0 / FRAMES, apply_time * 1000.0 / FRAMES, mutex_time / buffer_time);
+
+    for (auto times : applied)
+      if (times != (uint32_t) FRAMES) {
+        printf("Mismatch: a command was not applied once per frame\n");
+        return false;
+      }
+  }
+  return true;
+}
@@ -0,0 +1,171 @@
+// Benchmark entity_store
+// - Measures Update and Render CPU time of moving asteroids without collisions
+// - Compares polymorphic objects in a list of shared pointers, as Scene keeps them, with EntityStore systems
+// - Render collects the instance data the render queue receives in both cases
+// - Objects are linked in shuffled order to model the allocation pattern after some time of spawning and dying
+// - Optional argument is the number of asteroids (default 100000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <random>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
+#include "benchmark.h"
+#include "entity_store.h"
+
+const int FRAMES = 20;
+const float DT = 0.01f;
+
+// Helper types are local to this benchmark, other benchmarks define their own with the same names
+namespace {
+
+// Object and Asteroid of gl_scene without resources and collisions
+class BenchObject {
+public:
+  virtual ~BenchObject() {}
+  virtual bool Update(float dt) = 0;
+  virtual void Render(std::vector<MeshInstance> &instances) = 0;
+
+  glm::vec3 position{0.0f};
+  glm::vec3 rotation{0.0f};
+  glm::vec3 scale{1.0f};
+  glm::mat4 modelMatrix{1.0f};
+  float radius = 0.0f;
+};
+
+class BenchAsteroid : public BenchObject {
+public:
+  bool Update(float dt) override {
+    age += dt;
+    position += speed * dt;
+    rotation += rotMomentum * dt;
+    if (age > lifetime || position.y < -10) return false;
+    modelMatrix = glm::translate(glm::mat4(1.0f), position) * glm::orientate4(rotation)
+                  * glm::scale(glm::mat4(1.0f), scale);
+    return true;
+  }
+
+  void Render(std::vector<MeshInstance> &instances) override {
+    instances.push_back({modelMatrix, glm::vec4{1.0f}});
+  }
+
+  float age = 0.0f;
+  float lifetime = 1e9f;
+  glm::vec3 speed;
+  glm::vec3 rotMomentum;
+};
+
+} // namespace
+
+bool BenchmarkEntityStore(const std::vector<std::string> &args) {
+  int count = args.empty() ? 100000 : atoi(args[0].c_str());
+  if (count <= 0) count = 100000;
+
+  // Same motion for both, slow enough that hardly any asteroid leaves the play field
+  std::mt19937 random{1};
+  std::uniform_real_distribution<float> angle{-3.14f, 3.14f};
+  std::uniform_real_distribution<float> coordinate{-10.0f, 10.0f};
+  std::vector<glm::vec3> positions, speeds, rotations, momenta;
+  for (int i = 0; i < count; i++) {
+    positions.push_back(glm::vec3{coordinate(random), coordinate(random), 0.0f});
+    speeds.push_back(glm::vec3{0.01f, -0.01f, 0.0f});
+    rotations.push_back(glm::vec3{angle(random), angle(random), angle(random)});
+    momenta.push_back(glm::vec3{angle(random), angle(random), angle(random)});
+  }
+  std::vector<MeshInstance> instances;
+  instances.reserve((size_t) count);
+
+  // Objects
+  double object_update, object_render;
+  glm::mat4 object_check;
+  {
+    std::vector<std::shared_ptr<BenchObject>> created;
+    for (int i = 0; i < count; i++) {
+      auto asteroid = std::make_shared<BenchAsteroid>();
+      asteroid->position = positions[i];
+      asteroid->rotation = rotations[i];
+      asteroid->speed = speeds[i];
+      asteroid->rotMomentum = momenta[i];
+      created.push_back(asteroid);
+    }
+    auto first = created[0];
+    std::shuffle(created.begin(), created.end(), random);
+    std::list<std::shared_ptr<BenchObject>> objects(created.begin(), created.end());
+
+    object_update = object_render = 0.0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+      Timer timer;
+      for (auto i = objects.begin(); i != objects.end();) {
+        if (!(*i)->Update(DT)) i = objects.erase(i);
+        else ++i;
+      }
+      object_update += timer.Elapsed();
+
+      timer.Reset();
+      instances.clear();
+      for (auto &obj : objects) obj->Render(instances);
+      object_render += timer.Elapsed();
+    }
+    object_check = first->modelMatrix;
+    object_update /= FRAMES;
+    object_render /= FRAMES;
+  }
+
+  // Entities
+  double entity_update, entity_render;
+  glm::mat4 entity_check;
+  {
+    EntityStore store;
+    Entity first = {0, 0};
+    for (int i = 0; i < count; i++) {
+      auto entity = store.Create();
+      auto index = store.GetIndex(entity);
+      store.position[index] = positions[i];
+      store.rotation[index] = rotations[i];
+      store.velocity[index] = speeds[i];
+      store.angularMomentum[index] = momenta[i];
+      if (i == 0) first = entity;
+    }
+
+    entity_update = entity_render = 0.0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+      Timer timer;
+      store.Integrate(DT);
+      store.DestroyIf([](const EntityStore &store, size_t i) {
+        return store.age[i] > store.lifetime[i] || store.position[i].y < -10;
+      });
+      store.UpdateModelMatrices();
+      entity_update += timer.Elapsed();
+
+      timer.Reset();
+      instances.clear();
+      for (size_t i = 0; i < store.Size(); i++) instances.push_back({store.modelMatrix[i], glm::vec4{1.0f}});
+      entity_render += timer.Elapsed();
+    }
+    entity_check = store.modelMatrix[store.GetIndex(first)];
+    entity_update /= FRAMES;
+    entity_render /= FRAMES;
+  }
+
+  printf("%d asteroids\n", count);
+  printf("%-10s %12s %12s %12s\n", "storage", "update [ms]", "render [ms]", "total [ms]");
+  printf("%-10s %12.3f %12.3f %12.3f\n", "objects", object_update * 1000.0, object_render * 1000.0,
+         (object_update + object_render) * 1000.0);
+  printf("%-10s %12.3f %12.3f %12.3f\n", "entities", entity_update * 1000.0, entity_render * 1000.0,
+         (entity_update + entity_render) * 1000.0);
+  printf("speedup %.2fx\n", (object_update + object_render) / (entity_update + entity_render));
+  // Entities compose matrices with polynomial sine and cosine, allow for their rounding
+  for (int column = 0; column < 4; column++)
+    for (int row = 0; row < 4; row++)
+      if (std::abs(object_check[column][row] - entity_check[column][row]) > 1e-4f) {
+        printf("Mismatch: model matrices differ\n");
+        return false;
+      }
+  return true;
+}
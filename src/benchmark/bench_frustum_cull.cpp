@@ -0,0 +1,74 @@
+// Benchmark frustum_cull
+// - Measures CPU time of culling random bounding spheres against the gl_scene camera frustum
+// - Compares a sphere at a time test on an array of structures with the blocked Frustum::Cull on structure of arrays
+// - Optional argument is the number of spheres (default 100000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "benchmark.h"
+#include "frustum.h"
+
+const int REPEAT = 100;
+
+struct Sphere {
+  glm::vec3 center;
+  float radius;
+};
+
+bool BenchmarkFrustumCull(const std::vector<std::string> &args) {
+  int count = args.empty() ? 100000 : atoi(args[0].c_str());
+  if (count <= 0) count = 100000;
+
+  // Same projection and view as the gl_scene camera
+  auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+  auto view = glm::lookAt(glm::vec3{0.0f, 0.0f, -15.0f}, glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+  Frustum frustum;
+  frustum.Update(projection * view);
+
+  // Spheres spread over a box around the camera so about one in seven of them is visible
+  std::mt19937 random{1};
+  std::uniform_real_distribution<float> position{-50.0f, 50.0f};
+  std::uniform_real_distribution<float> radius{0.1f, 3.0f};
+  std::vector<Sphere> aos((size_t) count);
+  SphereList soa;
+  for (auto &sphere : aos) {
+    sphere.center = glm::vec3{position(random), position(random), position(random)};
+    sphere.radius = radius(random);
+    soa.Add(sphere.center, sphere.radius);
+  }
+  std::vector<uint8_t> visible((size_t) count);
+
+  // One sphere at a time, as a per object visibility check would do
+  size_t scalar_visible = 0;
+  Timer timer;
+  for (int i = 0; i < REPEAT; i++) {
+    scalar_visible = 0;
+    for (size_t j = 0; j < aos.size(); j++) {
+      visible[j] = (uint8_t) frustum.IsVisible(aos[j].center, aos[j].radius);
+      scalar_visible += visible[j];
+    }
+  }
+  double scalar_time = timer.Elapsed() / REPEAT;
+
+  // Blocks of spheres against all planes at once
+  size_t blocked_visible = 0;
+  timer.Reset();
+  for (int i = 0; i < REPEAT; i++)
+    blocked_visible = frustum.Cull(soa, visible.data());
+  double blocked_time = timer.Elapsed() / REPEAT;
+
+  printf("%d spheres, %zu visible, %zu culled\n", count, blocked_visible, count - blocked_visible);
+  printf("%-10s %10s %12s\n", "method", "time [ms]", "ns/sphere");
+  printf("%-10s %10.3f %12.2f\n", "scalar", scalar_time * 1000.0, scalar_time * 1e9 / count);
+  printf("%-10s %10.3f %12.2f\n", "blocked", blocked_time * 1000.0, blocked_time * 1e9 / count);
+  printf("speedup %.2fx\n", scalar_time / blocked_time);
+  if (scalar_visible != blocked_visible) {
+    printf("Mismatch: scalar test found %zu visible spheres\n", scalar_visible);
+    return false;
+  }
+  return true;
+}
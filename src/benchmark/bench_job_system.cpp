@@ -0,0 +1,181 @@
+// Benchmark job_system
+// - Measures the two phase update of an asteroid scene, as Scene runs it, from 1 thread up to the number of cores
+// - Simulate moves the asteroids and finds collisions against the start of frame snapshot in parallel
+// - The serial phase explodes colliding asteroids into pieces and removes expired ones in scene order
+// - Checks that every thread count ends in a state bit identical to the single threaded run
+// - Optional argument is the number of asteroids (default 50000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "benchmark.h"
+#include "job_system.h"
+#include "spatial_hash.h"
+#include "transform.h"
+
+const int FRAMES = 30;
+const float DT = 0.02f;
+const size_t GRAIN = 256;
+
+// Kept to this file, other benchmarks have their own BenchAsteroid
+namespace {
+
+// Asteroid of gl_scene without resources, Simulate and Update split the same way
+struct BenchAsteroid {
+  glm::vec3 position, rotation, scale;
+  glm::vec3 speed, rotMomentum;
+  glm::vec3 snapshotPosition, snapshotScale;
+  glm::mat4 modelMatrix;
+  float age;
+  size_t collisionId;
+  BenchAsteroid *hit;
+};
+typedef std::unique_ptr<BenchAsteroid> BenchAsteroidPtr;
+
+class BenchScene {
+public:
+  BenchScene(unsigned int threads, size_t count) : jobs{threads}, collisions{2.0f}, random{1} {
+    std::uniform_real_distribution<float> coordinate{-150.0f, 150.0f};
+    std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> size{0.3f, 1.0f};
+    std::uniform_real_distribution<float> age{0.0f, 1.0f};
+    for (size_t i = 0; i < count; i++) {
+      BenchAsteroidPtr asteroid{new BenchAsteroid()};
+      asteroid->position = glm::vec3{coordinate(random), coordinate(random), 0.0f};
+      asteroid->rotation = glm::vec3{unit(random), unit(random), unit(random)} * 3.14f;
+      asteroid->scale = glm::vec3{size(random)};
+      asteroid->speed = glm::vec3{unit(random), unit(random), 0.0f} * 5.0f;
+      asteroid->rotMomentum = glm::vec3{unit(random), unit(random), unit(random)};
+      asteroid->age = age(random);
+      objects.push_back(std::move(asteroid));
+    }
+  }
+
+  // Returns the seconds spent in the Simulate phase
+  double Update(float dt) {
+    collisions.Clear();
+    for (auto &obj : objects) {
+      obj->snapshotPosition = obj->position;
+      obj->snapshotScale = obj->scale;
+      obj->collisionId = collisions.Insert(0, obj->position, obj->scale.y * 0.7f, obj.get());
+    }
+    collisions.Build();
+
+    Timer timer;
+    jobs.ParallelFor(objects.size(), GRAIN, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) simulate(*objects[i], dt);
+    });
+    double simulate_time = timer.Elapsed();
+
+    // Serial phase, spawned pieces and removals are applied after it as in Scene
+    std::vector<BenchAsteroidPtr> spawned;
+    std::vector<uint8_t> destroyed(objects.size(), 0);
+    for (size_t i = 0; i < objects.size(); i++) {
+      auto &obj = *objects[i];
+      bool expired = obj.age > 10.0f || obj.position.y < -200.0f;
+      if (!expired && obj.hit && !collisions.IsRemoved(obj.hit->collisionId)) {
+        explode(obj, spawned);
+        expired = true;
+      }
+      if (expired) {
+        collisions.Remove(obj.collisionId);
+        destroyed[i] = 1;
+      }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < objects.size(); i++)
+      if (!destroyed[i]) objects[kept++] = std::move(objects[i]);
+    objects.resize(kept);
+    for (auto &obj : spawned) objects.push_back(std::move(obj));
+    return simulate_time;
+  }
+
+  // Compares positions, rotations and matrices bit by bit
+  bool SameState(const BenchScene &other) const {
+    if (objects.size() != other.objects.size()) return false;
+    for (size_t i = 0; i < objects.size(); i++) {
+      auto &a = *objects[i], &b = *other.objects[i];
+      if (memcmp(&a.position, &b.position, sizeof(a.position)) || memcmp(&a.rotation, &b.rotation, sizeof(a.rotation))
+          || memcmp(&a.modelMatrix, &b.modelMatrix, sizeof(a.modelMatrix)))
+        return false;
+    }
+    return true;
+  }
+
+  size_t Size() const {
+    return objects.size();
+  }
+
+private:
+  void simulate(BenchAsteroid &obj, float dt) const {
+    obj.age += dt;
+    obj.position += obj.speed * dt;
+    obj.rotation += obj.rotMomentum * dt;
+    obj.hit = nullptr;
+    if (obj.age >= 0.5f) {
+      collisions.Query(0, obj.position, obj.scale.y * 0.7f, [&](BenchAsteroid *other) {
+        if (obj.hit || other == &obj) return;
+        if (glm::distance(obj.position, other->snapshotPosition) < (other->snapshotScale.y + obj.scale.y) * 0.7f)
+          obj.hit = other;
+      });
+    }
+    obj.modelMatrix = ComposeTransform(obj.position, obj.rotation, obj.scale);
+  }
+
+  void explode(const BenchAsteroid &obj, std::vector<BenchAsteroidPtr> &spawned) {
+    if (obj.scale.y < 0.5f) return;
+    std::uniform_real_distribution<float> spread{-3.0f, 3.0f};
+    for (int i = 0; i < 3; i++) {
+      BenchAsteroidPtr piece{new BenchAsteroid(obj)};
+      piece->speed += glm::vec3{spread(random), spread(random), 0.0f};
+      piece->scale = obj.scale / 1.5f;
+      piece->age = 0.0f;
+      spawned.push_back(std::move(piece));
+    }
+  }
+
+  JobSystem jobs;
+  SpatialHash<BenchAsteroid *> collisions;
+  std::mt19937 random;
+  std::vector<BenchAsteroidPtr> objects;
+};
+
+} // namespace
+
+bool BenchmarkJobSystem(const std::vector<std::string> &args) {
+  int count = args.empty() ? 50000 : atoi(args[0].c_str());
+  if (count <= 0) count = 50000;
+
+  unsigned int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  printf("%d asteroids, hardware threads: %u\n", count, std::thread::hardware_concurrency());
+  printf("%-8s %14s %14s %12s %10s\n", "threads", "simulate [ms]", "update [ms]", "asteroids", "speed-up");
+
+  std::unique_ptr<BenchScene> serial;
+  double serial_time = 0.0;
+  for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+    std::unique_ptr<BenchScene> scene{new BenchScene(threads, (size_t) count)};
+    double simulate_time = 0.0;
+    Timer timer;
+    for (int frame = 0; frame < FRAMES; frame++) simulate_time += scene->Update(DT);
+    double update_time = timer.Elapsed();
+    if (threads == 1) serial_time = simulate_time;
+
+    printf("%-8u %14.3f %14.3f %12zu %9.2fx\n", threads, simulate_time * 1000.0 / FRAMES,
+           update_time * 1000.0 / FRAMES, scene->Size(), serial_time / simulate_time);
+
+    if (!serial) {
+      serial = std::move(scene);
+    } else if (!scene->SameState(*serial)) {
+      printf("Mismatch: %u threads differ from the serial update\n", threads);
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,156 @@
+// Benchmark layer_registry
+// - Measures one frame of gameplay systems that each visit the objects of one kind, as in gl_scene
+// - Compares scanning the object list with std::dynamic_pointer_cast against iterating LayerRegistry lists
+// - Every frame one percent of the objects is removed and replaced, so both include the bookkeeping
+// - Optional arguments are object counts (default 1000 10000 100000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <random>
+
+#include <glm/vec3.hpp>
+
+#include "benchmark.h"
+#include "layer_registry.h"
+
+const int FRAMES = 100;
+
+enum BenchLayer {
+  BENCH_ASTEROID = 0,
+  BENCH_FOOD,
+  BENCH_WALL,
+  BENCH_LAYERS
+};
+
+// Internal linkage, the entity_store and job_system benchmarks have classes of the same names
+namespace {
+
+// Polymorphic objects laid out like the scene objects
+struct BenchObject {
+  virtual ~BenchObject() {}
+
+  glm::vec3 position;
+  glm::vec3 speed;
+  unsigned int layer;
+  size_t layerIndex;
+};
+
+struct BenchAsteroid : BenchObject {
+};
+
+struct BenchFood : BenchObject {
+  float age = 0.0f;
+};
+
+struct BenchWall : BenchObject {
+};
+
+typedef std::shared_ptr<BenchObject> BenchObjectPtr;
+
+} // namespace
+
+static BenchObjectPtr CreateObject(std::mt19937 &random) {
+  BenchObjectPtr obj;
+  auto layer = (unsigned int) (random() % BENCH_LAYERS);
+  if (layer == BENCH_ASTEROID) obj = BenchObjectPtr(new BenchAsteroid{});
+  else if (layer == BENCH_FOOD) obj = BenchObjectPtr(new BenchFood{});
+  else obj = BenchObjectPtr(new BenchWall{});
+  obj->layer = layer;
+  obj->position = glm::vec3{(float) (random() % 100), (float) (random() % 100), 0.0f};
+  obj->speed = glm::vec3{1.0f, -1.0f, 0.0f};
+  return obj;
+}
+
+// Systems find their objects by casting every object of the scene
+static uint64_t ScanFrame(std::list<BenchObjectPtr> &objects, float dt) {
+  for (auto &obj : objects) {
+    auto asteroid = std::dynamic_pointer_cast<BenchAsteroid>(obj);
+    if (asteroid) asteroid->position += asteroid->speed * dt;
+  }
+  for (auto &obj : objects) {
+    auto food = std::dynamic_pointer_cast<BenchFood>(obj);
+    if (food) food->age += dt;
+  }
+  uint64_t sum = 0;
+  for (auto &obj : objects) {
+    auto wall = std::dynamic_pointer_cast<BenchWall>(obj);
+    if (wall) sum += (uint64_t) wall->position.x;
+  }
+  return sum;
+}
+
+// Systems iterate the list of their layer
+static uint64_t RegistryFrame(const LayerRegistry<BenchObject> &registry, float dt) {
+  for (auto obj : registry.Get(BENCH_ASTEROID)) obj->position += obj->speed * dt;
+  for (auto obj : registry.Get(BENCH_FOOD)) static_cast<BenchFood *>(obj)->age += dt;
+  uint64_t sum = 0;
+  for (auto obj : registry.Get(BENCH_WALL)) sum += (uint64_t) obj->position.x;
+  return sum;
+}
+
+bool BenchmarkLayerRegistry(const std::vector<std::string> &args) {
+  std::vector<size_t> counts;
+  for (auto &arg : args)
+    if (atoi(arg.c_str()) > 0) counts.push_back((size_t) atoi(arg.c_str()));
+  if (counts.empty()) counts = {1000, 10000, 100000};
+
+  printf("%8s %12s %14s %10s\n", "objects", "scan [ms]", "registry [ms]", "speedup");
+  for (auto count : counts) {
+    size_t churn = std::max<size_t>(count / 100, 1);
+    // Sums of the wall x coordinates returned by the frames, walls stay at whole numbers
+    // so the integer sums do not depend on the order the objects were visited in
+    uint64_t checksum[2] = {0, 0};
+    double time[2];
+
+    // Object list with dynamic casts, removal by erasing from the list
+    {
+      std::mt19937 random{1};
+      std::list<BenchObjectPtr> objects;
+      for (size_t i = 0; i < count; i++) objects.push_back(CreateObject(random));
+
+      Timer timer;
+      for (int frame = 0; frame < FRAMES; frame++) {
+        checksum[0] += ScanFrame(objects, 0.01f);
+        for (size_t i = 0; i < churn; i++) {
+          objects.pop_front();
+          objects.push_back(CreateObject(random));
+        }
+      }
+      time[0] = timer.Elapsed() / FRAMES;
+    }
+
+    // Object list for ownership, registry for the systems
+    {
+      std::mt19937 random{1};
+      std::list<BenchObjectPtr> objects;
+      LayerRegistry<BenchObject> registry{BENCH_LAYERS};
+      for (size_t i = 0; i < count; i++) {
+        objects.push_back(CreateObject(random));
+        registry.Add(objects.back().get());
+      }
+
+      Timer timer;
+      for (int frame = 0; frame < FRAMES; frame++) {
+        checksum[1] += RegistryFrame(registry, 0.01f);
+        for (size_t i = 0; i < churn; i++) {
+          registry.Remove(objects.front().get());
+          objects.pop_front();
+          objects.push_back(CreateObject(random));
+          registry.Add(objects.back().get());
+        }
+      }
+      time[1] = timer.Elapsed() / FRAMES;
+    }
+
+    printf("%8zu %12.3f %14.3f %9.1fx\n", count, time[0] * 1000.0, time[1] * 1000.0, time[0] / time[1]);
+    if (checksum[0] != checksum[1]) {
+      printf("Mismatch: systems visited different objects\n");
+      return false;
+    }
+  }
+  return true;
+}
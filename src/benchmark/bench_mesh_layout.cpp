@@ -0,0 +1,107 @@
+// Benchmark mesh_layout
+// - Compares the previous separate position/texcoord/normal buffers with the interleaved float and quantized layouts
+// - Reports GPU memory footprint and CPU packing time, upload time is measured when an OpenGL context can be created
+// - Without arguments the default models and a synthetic 200k triangle sphere are used
+
+#include <cstdio>
+
+#include <GL/glew.h>
+
+#include "benchmark.h"
+#include "tiny_obj_loader.h"
+#include "vertex_format.h"
+
+const int REPEAT = 10;
+
+// Buffers as built by Mesh before the interleaved layout, one vector per attribute filled by push_back
+struct SeparateBuffers {
+  std::vector<GLfloat> positions, texcoords, normals;
+  std::vector<GLuint> indices;
+
+  size_t Size() const {
+    return (positions.size() + texcoords.size() + normals.size()) * sizeof(GLfloat) + indices.size() * sizeof(GLuint);
+  }
+};
+
+static SeparateBuffers PackSeparate(const std::vector<tinyobj::shape_t> &shapes) {
+  SeparateBuffers buffers;
+  GLuint base_vertex = 0;
+  for (auto &shape : shapes) {
+    auto &mesh = shape.mesh;
+    for (auto value : mesh.positions) buffers.positions.push_back(value);
+    for (auto value : mesh.texcoords) buffers.texcoords.push_back(value);
+    for (auto value : mesh.normals) buffers.normals.push_back(value);
+    for (auto index : mesh.indices) buffers.indices.push_back(base_vertex + index);
+    base_vertex += (GLuint) (mesh.positions.size() / 3);
+  }
+  return buffers;
+}
+
+// Average time of uploading the given buffers in seconds, waits for the driver to finish each upload
+static double MeasureUpload(const std::vector<std::pair<const void *, size_t>> &buffers) {
+  std::vector<GLuint> names(buffers.size());
+  glGenBuffers((GLsizei) names.size(), names.data());
+  Timer timer;
+  for (int i = 0; i < REPEAT; i++) {
+    for (size_t b = 0; b < buffers.size(); b++) {
+      glBindBuffer(GL_ARRAY_BUFFER, names[b]);
+      glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) buffers[b].second, buffers[b].first, GL_STATIC_DRAW);
+    }
+    glFinish();
+  }
+  double time = timer.Elapsed() / REPEAT;
+  glDeleteBuffers((GLsizei) names.size(), names.data());
+  return time;
+}
+
+bool BenchmarkMeshLayout(const std::vector<std::string> &args) {
+  auto files = GetObjFiles(args);
+  if (args.empty()) {
+    WriteSyntheticObj("synthetic_200k.obj", 200000);
+    files.push_back("synthetic_200k.obj");
+  }
+
+  bool upload = CreateHiddenContext();
+  if (!upload) printf("No OpenGL context, upload time is not measured\n");
+
+  printf("%-24s %-10s %12s %10s %12s %12s\n", "file", "layout", "size [kB]", "bytes/vtx", "pack [ms]", "upload [ms]");
+  for (auto &file : files) {
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    if (!tinyobj::LoadObjMapped(shapes, materials, file.c_str()).empty()) {
+      printf("%-24s failed to load\n", file.c_str());
+      continue;
+    }
+
+    // Previous layout
+    SeparateBuffers separate;
+    Timer timer;
+    for (int i = 0; i < REPEAT; i++) separate = PackSeparate(shapes);
+    double pack = timer.Elapsed() / REPEAT;
+    double send = upload ? MeasureUpload({{separate.positions.data(), separate.positions.size() * sizeof(GLfloat)},
+                                          {separate.texcoords.data(), separate.texcoords.size() * sizeof(GLfloat)},
+                                          {separate.normals.data(), separate.normals.size() * sizeof(GLfloat)},
+                                          {separate.indices.data(), separate.indices.size() * sizeof(GLuint)}}) : 0.0;
+    size_t vertices = separate.positions.size() / 3;
+    printf("%-24s %-10s %12.1f %10.1f %12.3f %12.3f\n", file.c_str(), "separate", (double) separate.Size() / 1024.0,
+           (double) separate.Size() / (double) vertices, pack * 1000.0, send * 1000.0);
+
+    // Interleaved layouts
+    const VertexFormat formats[] = {VertexFormat::Float, VertexFormat::Quantized};
+    const char *names[] = {"float", "quantized"};
+    for (int f = 0; f < 2; f++) {
+      PackedMesh packed;
+      timer.Reset();
+      for (int i = 0; i < REPEAT; i++) packed = PackMesh(shapes, materials.size(), formats[f]);
+      pack = timer.Elapsed() / REPEAT;
+      send = upload ? MeasureUpload({{packed.vertices.data(), packed.vertices.size()},
+                                     {packed.indices.data(), packed.indices.size()}}) : 0.0;
+      size_t size = packed.vertices.size() + packed.indices.size();
+      printf("%-24s %-10s %12.1f %10.1f %12.3f %12.3f\n", "", names[f], (double) size / 1024.0,
+             (double) size / (double) vertices, pack * 1000.0, send * 1000.0);
+    }
+  }
+
+  DestroyHiddenContext();
+  return true;
+}
@@ -0,0 +1,81 @@
+// Benchmark mesh_optimize
+// - Reports simulated vertex cache ACMR/ATVR and vertex fetch efficiency of each mesh before and after optimization
+// - Vertex fetch is simulated with a 16kB direct mapped cache of 64 byte lines, overfetch is read bytes per vertex byte
+// - Without arguments the default models and a synthetic 200k triangle sphere are used
+
+#include <cstdio>
+
+#include "benchmark.h"
+#include "tiny_obj_loader.h"
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+
+const size_t FETCH_LINE_SIZE = 64;
+const size_t FETCH_LINE_COUNT = 256;
+
+// Bytes read from memory for all transformed vertices divided by the size of the referenced vertices
+static double SimulateOverfetch(const PackedMesh &packed, const std::vector<uint32_t> &indices) {
+  std::vector<size_t> lines(FETCH_LINE_COUNT, (size_t) -1);
+  std::vector<bool> referenced(packed.vertex_count, false);
+  size_t fetched = 0, used = 0;
+  for (auto vertex : indices) {
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      used += packed.layout.stride;
+    }
+    size_t begin = vertex * packed.layout.stride / FETCH_LINE_SIZE;
+    size_t end = ((vertex + 1) * packed.layout.stride - 1) / FETCH_LINE_SIZE;
+    for (size_t line = begin; line <= end; line++) {
+      if (lines[line % FETCH_LINE_COUNT] != line) {
+        lines[line % FETCH_LINE_COUNT] = line;
+        fetched += FETCH_LINE_SIZE;
+      }
+    }
+  }
+  return used ? (double) fetched / (double) used : 0.0;
+}
+
+static void PrintStats(const char *file, const char *stage, const PackedMesh &packed, double time) {
+  auto indices = GetPackedIndices(packed);
+  auto stats = SimulateVertexCache(indices.data(), indices.size(), packed.vertex_count);
+  printf("%-24s %-16s %10zu %8.3f %8.3f %10.2f %10.2f\n", file, stage, stats.triangles, stats.acmr, stats.atvr,
+         SimulateOverfetch(packed, indices), time * 1000.0);
+}
+
+bool BenchmarkMeshOptimize(const std::vector<std::string> &args) {
+  auto files = GetObjFiles(args);
+  if (args.empty()) {
+    WriteSyntheticObj("synthetic_200k.obj", 200000);
+    files.push_back("synthetic_200k.obj");
+  }
+
+  const struct {
+    const char *name;
+    unsigned int flags;
+  } stages[] = {
+          {"cache", OPTIMIZE_VERTEX_CACHE},
+          {"cache+fetch", OPTIMIZE_VERTEX_CACHE | OPTIMIZE_VERTEX_FETCH},
+          {"cache+overdraw", OPTIMIZE_VERTEX_CACHE | OPTIMIZE_OVERDRAW | OPTIMIZE_VERTEX_FETCH},
+  };
+
+  printf("%-24s %-16s %10s %8s %8s %10s %10s\n", "file", "stage", "triangles", "ACMR", "ATVR", "overfetch", "time [ms]");
+  for (auto &file : files) {
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    if (!tinyobj::LoadObjMapped(shapes, materials, file.c_str()).empty()) {
+      printf("%-24s failed to load\n", file.c_str());
+      continue;
+    }
+
+    auto input = PackMesh(shapes, materials.size(), VertexFormat::Float);
+    PrintStats(file.c_str(), "input", input, 0.0);
+    for (auto &stage : stages) {
+      auto packed = input;
+      Timer timer;
+      OptimizePackedMesh(packed, stage.flags);
+      double time = timer.Elapsed();
+      PrintStats("", stage.name, packed, time);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,48 @@
+// Benchmark obj_cache
+// - Compares parsing OBJ text with tinyobj::LoadObj against loading the binary cache
+// - The cache is rebuilt for every file before measuring the warm load
+
+#include <cstdio>
+
+#include "benchmark.h"
+#include "obj_cache.h"
+
+const int REPEAT = 10;
+
+bool BenchmarkObjCache(const std::vector<std::string> &args) {
+  printf("%-24s %10s %12s %12s %9s\n", "file", "size [kB]", "parse [ms]", "cache [ms]", "speed-up");
+
+  for (auto &file : GetObjFiles(args)) {
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+
+    // Cold load, always parse the text
+    Timer timer;
+    for (int i = 0; i < REPEAT; i++) {
+      auto err = tinyobj::LoadObj(shapes, materials, file.c_str());
+      if (!err.empty()) {
+        printf("%-24s failed: %s\n", file.c_str(), err.c_str());
+        break;
+      }
+    }
+    double parse = timer.Elapsed() / REPEAT;
+    if (shapes.empty()) continue;
+
+    // Warm load, rebuild the cache first so the measurement never falls back to parsing
+    auto cache_file = GetObjCachePath(file);
+    std::remove(cache_file.c_str());
+    LoadObjCached(shapes, materials, file);
+    if (!ReadObjCache(shapes, materials, cache_file, file)) {
+      printf("%-24s failed to write %s\n", file.c_str(), cache_file.c_str());
+      continue;
+    }
+    timer.Reset();
+    for (int i = 0; i < REPEAT; i++)
+      LoadObjCached(shapes, materials, file);
+    double cache = timer.Elapsed() / REPEAT;
+
+    printf("%-24s %10.1f %12.3f %12.3f %8.1fx\n", file.c_str(), (double) GetFileSize(file) / 1024.0,
+           parse * 1000.0, cache * 1000.0, parse / cache);
+  }
+  return true;
+}
@@ -0,0 +1,127 @@
+// Benchmark obj_dedup
+// - Measures load time and peak resident memory of tinyobj::LoadObjMapped, which is dominated by vertex deduplication
+// - Each file is loaded in its own child process so the peak memory of one load does not hide the next one
+// - Every file is loaded with the current hash table vertex cache and with the old std::map one for comparison,
+//   the loader is compiled a second time with the std::map cache in bench_obj_dedup_map.cpp
+// - Without arguments synthetic 200k and 1M triangle spheres are used
+
+#include <cstdio>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark.h"
+#include "tiny_obj_loader.h"
+
+const int REPEAT = 3;
+
+struct DedupResult {
+  double time;
+  size_t vertices;
+  size_t indices;
+};
+
+// Loads a file and counts the vertices and indices of all shapes, returns false on error
+typedef bool (*DedupLoader)(const std::string &file, size_t &vertices, size_t &indices);
+
+static bool LoadObjHashCache(const std::string &file, size_t &vertices, size_t &indices) {
+  std::vector<tinyobj::shape_t> shapes;
+  std::vector<tinyobj::material_t> materials;
+  if (!tinyobj::LoadObjMapped(shapes, materials, file.c_str()).empty()) return false;
+
+  vertices = indices = 0;
+  for (auto &shape : shapes) {
+    vertices += shape.mesh.positions.size() / 3;
+    indices += shape.mesh.indices.size();
+  }
+  return true;
+}
+
+// Average load time in seconds, negative on error
+static DedupResult MeasureDedup(const std::string &file, DedupLoader load) {
+  DedupResult result = {-1.0, 0, 0};
+  Timer timer;
+  for (int i = 0; i < REPEAT; i++)
+    if (!load(file, result.vertices, result.indices)) return result;
+  result.time = timer.Elapsed() / REPEAT;
+  return result;
+}
+
+// Runs the measurement in a child process, peak is set to its peak resident memory in kB or 0 if unknown
+static DedupResult MeasureDedupIsolated(const std::string &file, DedupLoader load, long &peak) {
+  peak = 0;
+#ifdef _WIN32
+  return MeasureDedup(file, load);
+#else
+  int channel[2];
+  if (pipe(channel) != 0) return MeasureDedup(file, load);
+
+  pid_t child = fork();
+  if (child == 0) {
+    close(channel[0]);
+    auto result = MeasureDedup(file, load);
+    ssize_t written = write(channel[1], &result, sizeof(result));
+    _exit(written == sizeof(result) ? 0 : 1);
+  }
+
+  close(channel[1]);
+  DedupResult result = {-1.0, 0, 0};
+  if (child < 0 || read(channel[0], &result, sizeof(result)) != sizeof(result)) result.time = -1.0;
+  close(channel[0]);
+
+  int status;
+  struct rusage usage;
+  if (child > 0 && wait4(child, &status, 0, &usage) == child) {
+#ifdef __APPLE__
+    peak = usage.ru_maxrss / 1024;
+#else
+    peak = usage.ru_maxrss;
+#endif
+  }
+  return result;
+#endif
+}
+
+bool BenchmarkObjDedup(const std::vector<std::string> &args) {
+  auto files = args;
+  if (files.empty()) {
+    WriteSyntheticObj("synthetic_200k.obj", 200000);
+    WriteSyntheticObj("synthetic_1m.obj", 1000000);
+    files = {"synthetic_200k.obj", "synthetic_1m.obj"};
+  }
+
+#ifdef TINY_OBJ_LOADER_MAP_VERTEX_CACHE
+  const char *current_cache = "map";
+#else
+  const char *current_cache = "hash";
+#endif
+
+  printf("%-24s %10s %10s %10s %-6s %10s %14s %9s\n", "file", "size [MB]", "vertices", "indices", "cache",
+         "time [ms]", "peak RSS [MB]", "speed-up");
+  bool equal = true;
+  for (auto &file : files) {
+    long peak[2];
+    DedupResult result[2] = {MeasureDedupIsolated(file, LoadObjMapCache, peak[0]),
+                             MeasureDedupIsolated(file, LoadObjHashCache, peak[1])};
+    if (result[0].time < 0.0 || result[1].time < 0.0) {
+      printf("%-24s failed to load\n", file.c_str());
+      continue;
+    }
+
+    const char *cache[2] = {"map", current_cache};
+    for (int i = 0; i < 2; i++)
+      printf("%-24s %10.1f %10zu %10zu %-6s %10.1f %14.1f %8.2fx\n", i == 0 ? file.c_str() : "",
+             (double) GetFileSize(file) / (1024.0 * 1024.0), result[i].vertices, result[i].indices, cache[i],
+             result[i].time * 1000.0, (double) peak[i] / 1024.0, result[0].time / result[i].time);
+
+    // Both caches must merge the same vertices
+    if (result[0].vertices != result[1].vertices || result[0].indices != result[1].indices) {
+      printf("Mismatch: the vertex caches produced different meshes\n");
+      equal = false;
+    }
+  }
+  return equal;
+}
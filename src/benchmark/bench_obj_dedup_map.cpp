@@ -0,0 +1,27 @@
+// OBJ loader with the std::map vertex cache for the obj_dedup benchmark
+// - Compiles tiny_obj_loader.cpp once more with TINY_OBJ_LOADER_MAP_VERTEX_CACHE into its own namespace,
+//   so the benchmark measures the old and the current vertex cache in the same binary
+
+#ifndef TINY_OBJ_LOADER_MAP_VERTEX_CACHE
+#define TINY_OBJ_LOADER_MAP_VERTEX_CACHE
+#endif
+#define tinyobj tinyobj_map_cache
+#include "tiny_obj_loader.cpp"
+#undef tinyobj
+
+// Declared in benchmark.h, which can not be included here because it includes the loader header with the
+// original namespace
+bool LoadObjMapCache(const std::string &file, size_t &vertices, size_t &indices);
+
+bool LoadObjMapCache(const std::string &file, size_t &vertices, size_t &indices) {
+  std::vector<tinyobj_map_cache::shape_t> shapes;
+  std::vector<tinyobj_map_cache::material_t> materials;
+  if (!tinyobj_map_cache::LoadObjMapped(shapes, materials, file.c_str()).empty()) return false;
+
+  vertices = indices = 0;
+  for (auto &shape : shapes) {
+    vertices += shape.mesh.positions.size() / 3;
+    indices += shape.mesh.indices.size();
+  }
+  return true;
+}
@@ -0,0 +1,76 @@
+// Benchmark obj_parallel
+// - Measures tinyobj::LoadObjParallel against the single threaded tinyobj::LoadObjMapped
+// - Without arguments a synthetic 1M triangle sphere is used
+// - Every thread count from 1 up to the number of cores (at least 4) is reported
+// - Checks that the shapes and materials of every thread count are equal to the ones of LoadObjMapped
+
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+
+#include "benchmark.h"
+#include "tiny_obj_loader.h"
+
+const int REPEAT = 3;
+
+// Average load time in seconds, negative on error
+template<typename Loader>
+static double MeasureLoad(Loader load) {
+  std::vector<tinyobj::shape_t> shapes;
+  std::vector<tinyobj::material_t> materials;
+  Timer timer;
+  for (int i = 0; i < REPEAT; i++)
+    if (!load(shapes, materials).empty()) return -1.0;
+  return timer.Elapsed() / REPEAT;
+}
+
+bool BenchmarkObjParallel(const std::vector<std::string> &args) {
+  auto files = args;
+  if (files.empty()) {
+    WriteSyntheticObj("synthetic_1m.obj", 1000000);
+    files.push_back("synthetic_1m.obj");
+  }
+
+  unsigned int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+
+  bool equal = true;
+  for (auto &file : files) {
+    double megabytes = (double) GetFileSize(file) / (1024.0 * 1024.0);
+    printf("%s (%.1f MB)\n", file.c_str(), megabytes);
+
+    double sequential = MeasureLoad([&](std::vector<tinyobj::shape_t> &shapes,
+                                        std::vector<tinyobj::material_t> &materials) {
+      return tinyobj::LoadObjMapped(shapes, materials, file.c_str());
+    });
+    if (sequential < 0.0) {
+      printf("  failed to load\n");
+      continue;
+    }
+
+    std::vector<tinyobj::shape_t> expected_shapes;
+    std::vector<tinyobj::material_t> expected_materials;
+    tinyobj::LoadObjMapped(expected_shapes, expected_materials, file.c_str());
+
+    printf("  %-10s %10s %10s %9s\n", "threads", "time [ms]", "MB/s", "speed-up");
+    printf("  %-10s %10.1f %10.1f %8.2fx\n", "mapped", sequential * 1000.0, megabytes / sequential, 1.0);
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+      double parallel = MeasureLoad([&](std::vector<tinyobj::shape_t> &shapes,
+                                        std::vector<tinyobj::material_t> &materials) {
+        return tinyobj::LoadObjParallel(shapes, materials, file.c_str(), nullptr, threads);
+      });
+      printf("  %-10u %10.1f %10.1f %8.2fx\n", threads, parallel * 1000.0, megabytes / parallel,
+             sequential / parallel);
+
+      std::vector<tinyobj::shape_t> shapes;
+      std::vector<tinyobj::material_t> materials;
+      auto err = tinyobj::LoadObjParallel(shapes, materials, file.c_str(), nullptr, threads);
+      auto difference = err.empty() ? CompareObjData(expected_shapes, expected_materials, shapes, materials) : err;
+      if (!difference.empty()) {
+        printf("Mismatch: %u threads differ from LoadObjMapped in %s\n", threads, difference.c_str());
+        equal = false;
+      }
+    }
+  }
+  return equal;
+}
@@ -0,0 +1,112 @@
+// Benchmark obj_parse
+// - Measures parser throughput of tinyobj::LoadObj (std::istream) and tinyobj::LoadObjMapped
+// - Without arguments the default models and a synthetic 200k triangle sphere are used
+// - Checks that LoadObjMapped returns the same shapes and materials as LoadObj, field by field
+// - Without arguments every OBJ of data and project/Pacman is checked, read from the source tree above the install
+//   directory, otherwise the given files are checked
+
+#include <cstdio>
+#include <iterator>
+
+#include "benchmark.h"
+#include "tiny_obj_loader.h"
+
+const int REPEAT = 5;
+
+// All OBJ files of the repository relative to the install directory
+const char *REPOSITORY_OBJ_FILES[] = {
+        "../data/asteroid.obj",
+        "../data/corsair.obj",
+        "../data/cube.obj",
+        "../data/food.obj",
+        "../data/missile.obj",
+        "../data/pacman.obj",
+        "../data/quad.obj",
+        "../data/sphere.obj",
+        "../data/wall.obj",
+        "../project/Pacman/Maze Ghosts/Ghost Blue/MazeGhostBlue.obj",
+        "../project/Pacman/Maze Ghosts/Ghost Dark Blue/MazeGhostDarkBlue.obj",
+        "../project/Pacman/Maze Ghosts/Ghost Orange/MazeGhostOrange.obj",
+        "../project/Pacman/Maze Ghosts/Ghost Pink/MazeGhostPink.obj",
+        "../project/Pacman/Maze Ghosts/Ghost Red/MazeGhostRed.obj",
+        "../project/Pacman/Maze Ghosts/Ghost White/MazeGhostWhite.obj",
+};
+
+// Average load time in seconds, negative on error
+template<typename Loader>
+double MeasureLoad(const std::string &file, Loader load) {
+  std::vector<tinyobj::shape_t> shapes;
+  std::vector<tinyobj::material_t> materials;
+  Timer timer;
+  for (int i = 0; i < REPEAT; i++)
+    if (!load(shapes, materials, file.c_str()).empty()) return -1.0;
+  return timer.Elapsed() / REPEAT;
+}
+
+// Loads the file with both loaders, returns false and reports the first difference
+static bool CheckMapped(const std::string &file) {
+  // Materials are looked up next to the OBJ file
+  auto separator = file.find_last_of("/\\");
+  std::string basepath = separator == std::string::npos ? "" : file.substr(0, separator + 1);
+
+  std::vector<tinyobj::shape_t> stream_shapes, mapped_shapes;
+  std::vector<tinyobj::material_t> stream_materials, mapped_materials;
+  auto stream_error = tinyobj::LoadObj(stream_shapes, stream_materials, file.c_str(), basepath.c_str());
+  auto mapped_error = tinyobj::LoadObjMapped(mapped_shapes, mapped_materials, file.c_str(), basepath.c_str());
+  if (!stream_error.empty() || !mapped_error.empty()) {
+    printf("Mismatch: %s failed to load: %s\n", file.c_str(),
+           (stream_error.empty() ? mapped_error : stream_error).c_str());
+    return false;
+  }
+
+  auto difference = CompareObjData(stream_shapes, stream_materials, mapped_shapes, mapped_materials);
+  if (!difference.empty()) {
+    printf("Mismatch: %s differs in %s\n", file.c_str(), difference.c_str());
+    return false;
+  }
+
+  printf("%-24s %zu shapes, %zu materials equal\n", file.substr(separator + 1).c_str(), stream_shapes.size(),
+         stream_materials.size());
+  return true;
+}
+
+bool BenchmarkObjParse(const std::vector<std::string> &args) {
+  auto files = GetObjFiles(args);
+  if (args.empty()) {
+    WriteSyntheticObj("synthetic_200k.obj", 200000);
+    files.push_back("synthetic_200k.obj");
+  }
+
+  printf("%-24s %10s %14s %14s %9s\n", "file", "size [kB]", "stream [MB/s]", "mapped [MB/s]", "speed-up");
+  for (auto &file : files) {
+    double megabytes = (double) GetFileSize(file) / (1024.0 * 1024.0);
+
+    double stream = MeasureLoad(file, [](std::vector<tinyobj::shape_t> &shapes,
+                                         std::vector<tinyobj::material_t> &materials, const char *filename) {
+      return tinyobj::LoadObj(shapes, materials, filename);
+    });
+    double mapped = MeasureLoad(file, [](std::vector<tinyobj::shape_t> &shapes,
+                                         std::vector<tinyobj::material_t> &materials, const char *filename) {
+      return tinyobj::LoadObjMapped(shapes, materials, filename);
+    });
+    if (stream < 0.0 || mapped < 0.0) {
+      printf("%-24s failed to load\n", file.c_str());
+      continue;
+    }
+
+    printf("%-24s %10.1f %14.1f %14.1f %8.2fx\n", file.c_str(), megabytes * 1024.0,
+           megabytes / stream, megabytes / mapped, stream / mapped);
+  }
+
+  std::vector<std::string> checked = args;
+  if (checked.empty()) {
+    checked.assign(std::begin(REPOSITORY_OBJ_FILES), std::end(REPOSITORY_OBJ_FILES));
+    checked.push_back("synthetic_200k.obj");
+  }
+
+  printf("LoadObjMapped compared to LoadObj\n");
+  bool equal = true;
+  for (auto &file : checked)
+    if (!CheckMapped(file)) equal = false;
+  return equal;
+}
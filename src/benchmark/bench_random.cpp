@@ -0,0 +1,70 @@
+// Benchmark random
+// - Measures float throughput of rand() as Object::Rand used it, Random::Float and the Random::Fill batch
+// - Reports the mean and a chi-square of 64 buckets per method, about 63 is expected from uniform numbers
+// - Checks that two generators with the same seed give the same numbers and other streams differ
+// - Optional argument is the number of floats (default 10000000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "benchmark.h"
+#include "random.h"
+
+const int BUCKETS = 64;
+
+static void PrintResult(const char *method, const std::vector<float> &numbers, double time) {
+  double sum = 0.0;
+  std::vector<size_t> buckets(BUCKETS, 0);
+  for (auto number : numbers) {
+    sum += number;
+    int bucket = (int) (number * BUCKETS);
+    buckets[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+  }
+  double expected = (double) numbers.size() / BUCKETS;
+  double chi_square = 0.0;
+  for (auto count : buckets) {
+    double deviation = (double) count - expected;
+    chi_square += deviation * deviation / expected;
+  }
+  printf("%-14s %10.3f %14.1f %10.5f %12.1f\n", method, time * 1000.0, (double) numbers.size() / time / 1e6,
+         sum / (double) numbers.size(), chi_square);
+}
+
+bool BenchmarkRandom(const std::vector<std::string> &args) {
+  int count = args.empty() ? 10000000 : atoi(args[0].c_str());
+  if (count <= 0) count = 10000000;
+  std::vector<float> numbers((size_t) count);
+
+  printf("%d floats in [0, 1)\n", count);
+  printf("%-14s %10s %14s %10s %12s\n", "method", "time [ms]", "floats [M/s]", "mean", "chi-square");
+
+  Timer timer;
+  for (auto &number : numbers) number = (float) rand() / (float) RAND_MAX;
+  PrintResult("rand()", numbers, timer.Elapsed());
+
+  Random random{1};
+  timer.Reset();
+  for (auto &number : numbers) number = random.Float(0.0f, 1.0f);
+  PrintResult("Random::Float", numbers, timer.Elapsed());
+
+  timer.Reset();
+  random.Fill(numbers.data(), numbers.size(), 0.0f, 1.0f);
+  PrintResult("Random::Fill", numbers, timer.Elapsed());
+
+  // Reproducible per seed and stream
+  Random a{7, 1}, b{7, 1}, c{7, 2};
+  std::vector<float> fa(1000), fb(1000), fc(1000);
+  a.Fill(fa.data(), fa.size(), -1.0f, 1.0f);
+  b.Fill(fb.data(), fb.size(), -1.0f, 1.0f);
+  c.Fill(fc.data(), fc.size(), -1.0f, 1.0f);
+  if (a.Next() != b.Next() || memcmp(fa.data(), fb.data(), fa.size() * sizeof(float)) != 0) {
+    printf("Mismatch: generators with the same seed differ\n");
+    return false;
+  }
+  if (memcmp(fa.data(), fc.data(), fa.size() * sizeof(float)) == 0) {
+    printf("Mismatch: generators of different streams are equal\n");
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,92 @@
+// Benchmark spatial_hash
+// - Measures one frame of scene collision queries, every object looks for overlapping objects of its layer
+// - Compares the all pairs loop the scene objects used before with SpatialHash build and queries
+// - Objects keep the same density at every count, so the hash time per object should stay about constant
+// - Optional arguments are object counts (default 100 1000 10000 100000), all pairs is skipped above 20000
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+
+#include <glm/geometric.hpp>
+
+#include "benchmark.h"
+#include "spatial_hash.h"
+
+const size_t MAX_ALL_PAIRS = 20000;
+
+struct Body {
+  glm::vec3 position;
+  float radius;
+  unsigned int layer;
+};
+
+// Number of overlapping pairs counted from both sides, as every object runs its own query
+static size_t AllPairs(const std::vector<Body> &bodies) {
+  size_t pairs = 0;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    for (size_t j = 0; j < bodies.size(); j++) {
+      if (i == j || bodies[i].layer != bodies[j].layer) continue;
+      if (glm::distance(bodies[i].position, bodies[j].position) < bodies[i].radius + bodies[j].radius) pairs++;
+    }
+  }
+  return pairs;
+}
+
+static size_t HashPairs(SpatialHash<const Body *> &hash, const std::vector<Body> &bodies) {
+  hash.Clear();
+  for (auto &body : bodies) hash.Insert(body.layer, body.position, body.radius, &body);
+  hash.Build();
+
+  size_t pairs = 0;
+  for (auto &body : bodies) {
+    hash.Query(body.layer, body.position, body.radius, [&](const Body *other) {
+      if (other != &body && glm::distance(body.position, other->position) < body.radius + other->radius) pairs++;
+    });
+  }
+  return pairs;
+}
+
+bool BenchmarkSpatialHash(const std::vector<std::string> &args) {
+  std::vector<size_t> counts;
+  for (auto &arg : args)
+    if (atoi(arg.c_str()) > 0) counts.push_back((size_t) atoi(arg.c_str()));
+  if (counts.empty()) counts = {100, 1000, 10000, 100000};
+
+  printf("%8s %10s %10s %14s %14s %10s\n", "objects", "pairs", "all [ms]", "hash [ms]", "hash ns/obj", "speedup");
+  for (auto count : counts) {
+    // Flat play field like gl_scene, two layers and radii of the stress mode asteroids
+    std::mt19937 random{1};
+    float side = 2.0f * std::sqrt((float) count);
+    std::uniform_real_distribution<float> position{0.0f, side};
+    std::uniform_real_distribution<float> radius{0.1f, 0.6f};
+    std::vector<Body> bodies(count);
+    for (size_t i = 0; i < count; i++)
+      bodies[i] = {glm::vec3{position(random), position(random), 0.0f}, radius(random), (unsigned int) (i % 2)};
+
+    SpatialHash<const Body *> hash{2.0f, 2};
+    int repeat = count <= 1000 ? 100 : 10;
+    size_t pairs = 0;
+    Timer timer;
+    for (int i = 0; i < repeat; i++) pairs = HashPairs(hash, bodies);
+    double hash_time = timer.Elapsed() / repeat;
+
+    if (count > MAX_ALL_PAIRS) {
+      printf("%8zu %10zu %10s %14.3f %14.1f %10s\n", count, pairs, "-", hash_time * 1000.0,
+             hash_time * 1e9 / (double) count, "-");
+      continue;
+    }
+
+    timer.Reset();
+    size_t all_pairs = AllPairs(bodies);
+    double all_time = timer.Elapsed();
+    printf("%8zu %10zu %10.3f %14.3f %14.1f %9.1fx\n", count, pairs, all_time * 1000.0, hash_time * 1000.0,
+           hash_time * 1e9 / (double) count, all_time / hash_time);
+    if (all_pairs != pairs) {
+      printf("Mismatch: all pairs found %zu overlapping pairs\n", all_pairs);
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,96 @@
+// Benchmark transform
+// - Measures model matrix throughput of translate * orientate4 * scale with GLM, ComposeTransform and ComposeTransforms
+// - The batch is measured with all matrices dirty and with one in ten dirty, as with mostly static objects
+// - Checks that both composed paths match the GLM matrices
+// - Optional argument is the number of matrices (default 100000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
+#include "benchmark.h"
+#include "transform.h"
+
+const int REPEAT = 20;
+// Largest difference to GLM accepted, matrix elements are up to about 100
+const float TOLERANCE = 1e-4f;
+
+static float MaxError(const std::vector<glm::mat4> &a, const std::vector<glm::mat4> &b) {
+  float error = 0.0f;
+  for (size_t i = 0; i < a.size(); i++)
+    for (int column = 0; column < 4; column++)
+      for (int row = 0; row < 4; row++)
+        error = std::max(error, std::abs(a[i][column][row] - b[i][column][row]));
+  return error;
+}
+
+bool BenchmarkTransform(const std::vector<std::string> &args) {
+  int count = args.empty() ? 100000 : atoi(args[0].c_str());
+  if (count <= 0) count = 100000;
+
+  // Rotations accumulate over the lifetime of an object, so angles are not limited to one turn
+  std::mt19937 random{1};
+  std::uniform_real_distribution<float> coordinate{-100.0f, 100.0f};
+  std::uniform_real_distribution<float> angle{-30.0f, 30.0f};
+  std::uniform_real_distribution<float> size{0.1f, 3.0f};
+  std::vector<glm::vec3> position((size_t) count), rotation((size_t) count), scale((size_t) count);
+  for (int i = 0; i < count; i++) {
+    position[i] = glm::vec3{coordinate(random), coordinate(random), coordinate(random)};
+    rotation[i] = glm::vec3{angle(random), angle(random), angle(random)};
+    scale[i] = glm::vec3{size(random), size(random), size(random)};
+  }
+  std::vector<glm::mat4> reference((size_t) count), composed((size_t) count), batch((size_t) count);
+  std::vector<uint8_t> dirty((size_t) count);
+
+  Timer timer;
+  for (int r = 0; r < REPEAT; r++)
+    for (int i = 0; i < count; i++)
+      reference[i] = glm::translate(glm::mat4(1.0f), position[i]) * glm::orientate4(rotation[i])
+                     * glm::scale(glm::mat4(1.0f), scale[i]);
+  double glm_time = timer.Elapsed() / REPEAT;
+
+  timer.Reset();
+  for (int r = 0; r < REPEAT; r++)
+    for (int i = 0; i < count; i++) composed[i] = ComposeTransform(position[i], rotation[i], scale[i]);
+  double scalar_time = timer.Elapsed() / REPEAT;
+
+  timer.Reset();
+  for (int r = 0; r < REPEAT; r++) {
+    std::fill(dirty.begin(), dirty.end(), 1);
+    ComposeTransforms(position.data(), rotation.data(), scale.data(), dirty.data(), batch.data(), (size_t) count);
+  }
+  double batch_time = timer.Elapsed() / REPEAT;
+
+  // Time per dirty matrix, the cost of skipping the clean ones is included
+  std::vector<uint8_t> pattern((size_t) count);
+  for (auto &flag : pattern) flag = (uint8_t) (random() % 10 == 0);
+  size_t updated = 0;
+  timer.Reset();
+  for (int r = 0; r < REPEAT; r++) {
+    std::copy(pattern.begin(), pattern.end(), dirty.begin());
+    updated += ComposeTransforms(position.data(), rotation.data(), scale.data(), dirty.data(), batch.data(),
+                                 (size_t) count);
+  }
+  double dirty_time = timer.Elapsed() / REPEAT;
+  double dirty_count = (double) updated / REPEAT;
+
+  printf("%d matrices, %s batch kernel\n", count, IsTransformSimd() ? "SSE2" : "scalar");
+  printf("%-16s %10s %16s\n", "method", "time [ms]", "matrices [M/s]");
+  printf("%-16s %10.3f %16.1f\n", "glm", glm_time * 1000.0, count / glm_time / 1e6);
+  printf("%-16s %10.3f %16.1f\n", "compose", scalar_time * 1000.0, count / scalar_time / 1e6);
+  printf("%-16s %10.3f %16.1f\n", "batch", batch_time * 1000.0, count / batch_time / 1e6);
+  printf("%-16s %10.3f %16.1f\n", "batch 10% dirty", dirty_time * 1000.0, dirty_count / dirty_time / 1e6);
+
+  // The last dirty run left some matrices stale, compose all of them once more for the comparison
+  ComposeTransforms(position.data(), rotation.data(), scale.data(), nullptr, batch.data(), (size_t) count);
+  float scalar_error = MaxError(reference, composed);
+  float batch_error = MaxError(reference, batch);
+  bool ok = scalar_error <= TOLERANCE && batch_error <= TOLERANCE;
+  printf("Max difference to glm: compose %g, batch %g, %s\n", scalar_error, batch_error, ok ? "ok" : "FAILED");
+  return ok;
+}
@@ -0,0 +1,216 @@
+// Benchmark runner
+// - Collects CPU side benchmarks of the PPGSO library in a single executable
+// - Run from the install directory so the default data files can be found
+// - Usage: benchmark <name> [arguments], without a name all benchmarks are listed
+// - Exits with failure when the benchmark finds a mismatch in its results
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "benchmark.h"
+
+struct Benchmark {
+  const char *name;
+  const char *description;
+  bool (*run)(const std::vector<std::string> &args);
+};
+
+const Benchmark BENCHMARKS[] = {
+        {"obj_cache", "Cold OBJ text parse versus warm binary cache load [obj files]", BenchmarkObjCache},
+        {"obj_parse", "Stream versus memory mapped OBJ parser throughput [obj files]", BenchmarkObjParse},
+        {"obj_parallel", "Multithreaded chunked OBJ parser scaling [obj files]", BenchmarkObjParallel},
+        {"obj_dedup", "OBJ vertex deduplication time and peak memory [obj files]", BenchmarkObjDedup},
+        {"mesh_layout", "Separate, interleaved and quantized vertex buffers memory and upload time [obj files]", BenchmarkMeshLayout},
+        {"mesh_optimize", "Vertex cache, overdraw and vertex fetch optimization statistics [obj files]", BenchmarkMeshOptimize},
+        {"shader_uniforms", "Uniform update CPU time with driver lookups, reflected names and typed handles [updates]", BenchmarkShaderUniforms},
+        {"frustum_cull", "Bounding sphere frustum culling, one at a time versus blocked structure of arrays [spheres]", BenchmarkFrustumCull},
+        {"spatial_hash", "Scene collision queries, all pairs versus spatial hash from 100 to 100k objects [counts]", BenchmarkSpatialHash},
+        {"layer_registry", "Per frame cost of finding objects by type, dynamic casts versus layer registries [counts]", BenchmarkLayerRegistry},
+        {"entity_store", "Moving asteroids as objects in a list versus structure of arrays entities [asteroids]", BenchmarkEntityStore},
+        {"transform", "Model matrix throughput and accuracy of GLM, composed and SSE batched transforms [matrices]", BenchmarkTransform},
+        {"command_buffer", "Spawn and destroy commands recorded from threads, shared mutex versus per thread buffers [commands]", BenchmarkCommandBuffer},
+        {"job_system", "Two phase asteroid update scaling from 1 to N threads, checked against the serial state [asteroids]", BenchmarkJobSystem},
+        {"random", "Random float throughput and uniformity of rand() versus xoshiro128** scalar and batched [floats]", BenchmarkRandom},
+};
+
+Timer::Timer() {
+  Reset();
+}
+
+void Timer::Reset() {
+  start = std::chrono::steady_clock::now();
+}
+
+double Timer::Elapsed() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<std::string> GetObjFiles(const std::vector<std::string> &args) {
+  if (!args.empty()) return args;
+  return {"asteroid.obj", "corsair.obj", "sphere.obj", "missile.obj", "pacman.obj", "food.obj", "cube.obj", "quad.obj"};
+}
+
+size_t GetFileSize(const std::string &filename) {
+  std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+  if (!stream.is_open()) return 0;
+  return (size_t) stream.tellg();
+}
+
+void WriteSyntheticObj(const std::string &filename, unsigned int triangles) {
+  // A UV sphere with n rings and 2n segments has 4n^2 triangles
+  auto rings = (unsigned int) std::ceil(std::sqrt(triangles / 4.0));
+  auto segments = 2 * rings;
+  const float PI = 3.14159265358979323846f;
+
+  std::ofstream obj(filename);
+  obj << "# Synthetic sphere with " << 2 * rings * segments << " triangles" << std::endl;
+  obj << "o sphere" << std::endl;
+  obj.setf(std::ios::fixed);
+  obj.precision(6);
+  for (unsigned int ring = 0; ring <= rings; ring++) {
+    for (unsigned int segment = 0; segment <= segments; segment++) {
+      float u = (float) segment / (float) segments;
+      float v = (float) ring / (float) rings;
+      float x = std::sin(v * PI) * std::cos(u * 2.0f * PI);
+      float y = std::cos(v * PI);
+      float z = std::sin(v * PI) * std::sin(u * 2.0f * PI);
+      obj << "v " << x << " " << y << " " << z << std::endl;
+      obj << "vn " << x << " " << y << " " << z << std::endl;
+      obj << "vt " << u << " " << v << std::endl;
+    }
+  }
+  for (unsigned int ring = 0; ring < rings; ring++) {
+    for (unsigned int segment = 0; segment < segments; segment++) {
+      unsigned int a = ring * (segments + 1) + segment + 1;
+      unsigned int b = a + segments + 1;
+      obj << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " "
+          << b + 1 << "/" << b + 1 << "/" << b + 1 << std::endl;
+      obj << "f " << a << "/" << a << "/" << a << " " << b + 1 << "/" << b + 1 << "/" << b + 1 << " "
+          << a + 1 << "/" << a + 1 << "/" << a + 1 << std::endl;
+    }
+  }
+}
+
+// Floats are compared by their bits, both loaders must produce exactly the same numbers
+template<typename T>
+static bool SameValues(const T *a, const T *b, size_t count) {
+  return count == 0 || memcmp(a, b, count * sizeof(T)) == 0;
+}
+
+template<typename T>
+static bool SameValues(const std::vector<T> &a, const std::vector<T> &b) {
+  return a.size() == b.size() && SameValues(a.data(), b.data(), a.size());
+}
+
+// Name of the first field that differs, empty when the outputs are equal
+static std::string CompareMaterial(const tinyobj::material_t &a, const tinyobj::material_t &b) {
+  if (a.name != b.name) return "name";
+  if (!SameValues(a.ambient, b.ambient, 3)) return "ambient";
+  if (!SameValues(a.diffuse, b.diffuse, 3)) return "diffuse";
+  if (!SameValues(a.specular, b.specular, 3)) return "specular";
+  if (!SameValues(a.transmittance, b.transmittance, 3)) return "transmittance";
+  if (!SameValues(a.emission, b.emission, 3)) return "emission";
+  if (!SameValues(&a.shininess, &b.shininess, 1)) return "shininess";
+  if (!SameValues(&a.ior, &b.ior, 1)) return "ior";
+  if (!SameValues(&a.dissolve, &b.dissolve, 1)) return "dissolve";
+  if (a.illum != b.illum) return "illum";
+  if (a.ambient_texname != b.ambient_texname) return "ambient_texname";
+  if (a.diffuse_texname != b.diffuse_texname) return "diffuse_texname";
+  if (a.specular_texname != b.specular_texname) return "specular_texname";
+  if (a.specular_highlight_texname != b.specular_highlight_texname) return "specular_highlight_texname";
+  if (a.bump_texname != b.bump_texname) return "bump_texname";
+  if (a.displacement_texname != b.displacement_texname) return "displacement_texname";
+  if (a.alpha_texname != b.alpha_texname) return "alpha_texname";
+  if (a.unknown_parameter != b.unknown_parameter) return "unknown_parameter";
+  return "";
+}
+
+static std::string CompareShape(const tinyobj::shape_t &a, const tinyobj::shape_t &b) {
+  if (a.name != b.name) return "name";
+  if (!SameValues(a.mesh.positions, b.mesh.positions)) return "mesh.positions";
+  if (!SameValues(a.mesh.normals, b.mesh.normals)) return "mesh.normals";
+  if (!SameValues(a.mesh.texcoords, b.mesh.texcoords)) return "mesh.texcoords";
+  if (!SameValues(a.mesh.indices, b.mesh.indices)) return "mesh.indices";
+  if (!SameValues(a.mesh.material_ids, b.mesh.material_ids)) return "mesh.material_ids";
+  return "";
+}
+
+std::string CompareObjData(const std::vector<tinyobj::shape_t> &shapes_a,
+                           const std::vector<tinyobj::material_t> &materials_a,
+                           const std::vector<tinyobj::shape_t> &shapes_b,
+                           const std::vector<tinyobj::material_t> &materials_b) {
+  if (shapes_a.size() != shapes_b.size())
+    return "shape count " + std::to_string(shapes_a.size()) + " and " + std::to_string(shapes_b.size());
+  for (size_t i = 0; i < shapes_a.size(); i++) {
+    auto field = CompareShape(shapes_a[i], shapes_b[i]);
+    if (!field.empty()) return "shape " + std::to_string(i) + " " + field;
+  }
+  if (materials_a.size() != materials_b.size())
+    return "material count " + std::to_string(materials_a.size()) + " and " + std::to_string(materials_b.size());
+  for (size_t i = 0; i < materials_a.size(); i++) {
+    auto field = CompareMaterial(materials_a[i], materials_b[i]);
+    if (!field.empty()) return "material " + std::to_string(i) + " " + field;
+  }
+  return "";
+}
+
+static GLFWwindow *hiddenWindow = nullptr;
+
+bool CreateHiddenContext() {
+  if (hiddenWindow) return true;
+  if (!glfwInit()) return false;
+
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+  hiddenWindow = glfwCreateWindow(64, 64, "PPGSO benchmark", nullptr, nullptr);
+  if (!hiddenWindow) {
+    glfwTerminate();
+    return false;
+  }
+  glfwMakeContextCurrent(hiddenWindow);
+
+  glewExperimental = GL_TRUE;
+  glewInit();
+  if (!glewIsSupported("GL_VERSION_3_3")) {
+    DestroyHiddenContext();
+    return false;
+  }
+  return true;
+}
+
+void DestroyHiddenContext() {
+  if (!hiddenWindow) return;
+  glfwDestroyWindow(hiddenWindow);
+  glfwTerminate();
+  hiddenWindow = nullptr;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <benchmark> [arguments]" << std::endl;
+    for (auto &benchmark : BENCHMARKS)
+      std::cout << "  " << benchmark.name << " - " << benchmark.description << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  std::string name = argv[1];
+  std::vector<std::string> args(argv + 2, argv + argc);
+  for (auto &benchmark : BENCHMARKS) {
+    if (name == benchmark.name) {
+      return benchmark.run(args) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+
+  std::cerr << "Unknown benchmark " << name << "!" << std::endl;
+  return EXIT_FAILURE;
+}
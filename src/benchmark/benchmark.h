@@ -0,0 +1,67 @@
+#ifndef PPGSO_BENCHMARK_H
+#define PPGSO_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "tiny_obj_loader.h"
+
+// Simple wall clock timer used by all benchmarks
+class Timer {
+public:
+  Timer();
+
+  void Reset();
+  // Elapsed time in seconds since construction or last Reset
+  double Elapsed() const;
+
+private:
+  std::chrono::steady_clock::time_point start;
+};
+
+// OBJ files passed on the command line or the default set of models from the install directory
+std::vector<std::string> GetObjFiles(const std::vector<std::string> &args);
+
+// Size of a file in bytes, 0 if it does not exist
+size_t GetFileSize(const std::string &filename);
+
+// Writes a tessellated sphere with positions, normals and texture coordinates to an OBJ file
+// The resulting mesh has at least the requested number of triangles
+void WriteSyntheticObj(const std::string &filename, unsigned int triangles);
+
+// Loads an OBJ file with tinyobj::LoadObjMapped built with the std::map vertex cache it used before the hash table
+// and counts the vertices and indices of all shapes, returns false on error
+bool LoadObjMapCache(const std::string &file, size_t &vertices, size_t &indices);
+
+// First difference between the outputs of two OBJ loads, such as "shape 0 mesh.indices", empty when they are equal
+// Floats are compared by their bits
+std::string CompareObjData(const std::vector<tinyobj::shape_t> &shapes_a,
+                           const std::vector<tinyobj::material_t> &materials_a,
+                           const std::vector<tinyobj::shape_t> &shapes_b,
+                           const std::vector<tinyobj::material_t> &materials_b);
+
+// Creates a hidden window with an OpenGL 3.3 core context for benchmarks that measure GPU work
+// Returns false when no context is available, e.g. on a machine without display
+bool CreateHiddenContext();
+void DestroyHiddenContext();
+
+// Benchmarks, each one receives the command line arguments following its name
+// and returns false when its check of the results fails
+bool BenchmarkObjCache(const std::vector<std::string> &args);
+bool BenchmarkObjParse(const std::vector<std::string> &args);
+bool BenchmarkObjParallel(const std::vector<std::string> &args);
+bool BenchmarkObjDedup(const std::vector<std::string> &args);
+bool BenchmarkMeshLayout(const std::vector<std::string> &args);
+bool BenchmarkMeshOptimize(const std::vector<std::string> &args);
+bool BenchmarkShaderUniforms(const std::vector<std::string> &args);
+bool BenchmarkFrustumCull(const std::vector<std::string> &args);
+bool BenchmarkSpatialHash(const std::vector<std::string> &args);
+bool BenchmarkLayerRegistry(const std::vector<std::string> &args);
+bool BenchmarkEntityStore(const std::vector<std::string> &args);
+bool BenchmarkTransform(const std::vector<std::string> &args);
+bool BenchmarkCommandBuffer(const std::vector<std::string> &args);
+bool BenchmarkJobSystem(const std::vector<std::string> &args);
+bool BenchmarkRandom(const std::vector<std::string> &args);
+
+#endif // PPGSO_BENCHMARK_H
@@ -1,5 +1,6 @@
 #include "asteroid.h"
 #include "explosion.h"
+#include "resource_cache.h"
 
 #include "object_frag.h"
 #include "object_vert.h"
@@ -7,6 +8,8 @@
 Asteroid::Asteroid() {
   // Reset the age to 0
   age = 0;
+  hit = nullptr;
+  layer = LAYER_ASTEROID;
 
   // Set random scale speed and rotation
   scale *= Rand(1.0f, 3.0f);
@@ -14,16 +17,36 @@ Asteroid::Asteroid() {
   rotation = glm::vec3(Rand(-PI, PI), Rand(-PI, PI), Rand(-PI, PI));
   rotMomentum = glm::vec3(Rand(-PI, PI), Rand(-PI, PI), Rand(-PI, PI));
 
+  InitializeResources();
+}
+
+void Asteroid::InitializeResources() {
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-  if (!texture) texture = TexturePtr(new Texture{"asteroid.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "asteroid.obj"});
+  if (!shader) shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("asteroid.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("asteroid.obj");
+}
+
+Entity Asteroid::CreateEntity(Scene &scene) {
+  InitializeResources();
+
+  // Same random motion as the constructor
+  auto &store = scene.entities;
+  auto entity = store.Create();
+  auto i = store.GetIndex(entity);
+  store.scale[i] *= Rand(1.0f, 3.0f);
+  store.velocity[i] = glm::vec3(Rand(-2.0f, 2.0f), Rand(-5.0f, -10.0f), 0.0f);
+  store.rotation[i] = glm::vec3(Rand(-PI, PI), Rand(-PI, PI), Rand(-PI, PI));
+  store.angularMomentum[i] = glm::vec3(Rand(-PI, PI), Rand(-PI, PI), Rand(-PI, PI));
+  store.lifetime[i] = 10.0f;
+  store.render[i] = store.AddRenderable(mesh, shader, texture);
+  return entity;
 }
 
 Asteroid::~Asteroid() {
 }
 
-bool Asteroid::Update(Scene &scene, float dt) {
+void Asteroid::Simulate(const Scene &scene, float dt) {
   // Count time alive
   age += dt;
 
@@ -33,50 +56,58 @@ bool Asteroid::Update(Scene &scene, float dt) {
   // Rotate the object
   rotation += rotMomentum * dt;
 
-  // Delete when alive longer than 10s or out of visibility
-  if (age > 10.0f || position.y < -10) return false;
-
-  // Collide with scene
-  for (auto obj : scene.objects) {
-    // Ignore self in scene
-    if (obj.get() == this) continue;
+  // Collide with nearby asteroids
+  // When colliding with other asteroids make sure the object is older than .5s
+  // This prevents excessive collisions when asteroids explode.
+  hit = nullptr;
+  if (age >= 0.5f && !IsExpired()) {
+    scene.collisions.Query(LAYER_ASTEROID, position, scale.y * 0.7f, [&](Object *obj) {
+      // Ignore self in scene, the first hit found wins
+      if (hit || obj == this) return;
+
+      // Compare distance to approximate size of the asteroid estimated from scale.
+      // Other asteroids move at the same time, use where they were at the start of the frame
+      if (glm::distance(position, obj->snapshotPosition) < (obj->snapshotScale.y + scale.y)*0.7f)
+        hit = static_cast<Asteroid *>(obj);
+    });
+  }
 
-    // We only need to collide with asteroids and projectiles, ignore other objects
-    auto asteroid = std::dynamic_pointer_cast<Asteroid>(obj);
-    if (!asteroid) continue;
+  // Generate modelMatrix from position, rotation and scale
+  GenerateModelMatrix();
+}
 
-    // When colliding with other asteroids make sure the object is older than .5s
-    // This prevents excessive collisions when asteroids explode.
-    if (asteroid && age < 0.5f) continue;
+bool Asteroid::Update(Scene &scene, float dt) {
+  // Delete when alive longer than 10s or out of visibility
+  if (IsExpired()) return false;
 
-    // Compare distance to approximate size of the asteroid estimated from scale.
-    if (glm::distance(position, obj->position) < (obj->scale.y + scale.y)*0.7f) {
-      int pieces = 3;
+  // An asteroid destroyed earlier in this frame no longer collides
+  if (hit && !scene.collisions.IsRemoved(hit->collisionId)) {
+    int pieces = 3;
 
-      // Too small to split into pieces
-      if (scale.y < 0.5) pieces = 0;
+    // Too small to split into pieces
+    if (scale.y < 0.5) pieces = 0;
 
-      // Generate smaller asteroids
-      Explode(scene, (obj->position+position)/2.0f, (obj->scale+scale)/2.0f, pieces);
+    // Generate smaller asteroids
+    Explode(scene, (hit->position+position)/2.0f, (hit->scale+scale)/2.0f, pieces);
 
-      // Destroy self
-      return false;
-    }
+    // Destroy self
+    return false;
   }
 
-  // Generate modelMatrix from position, rotation and scale
-  GenerateModelMatrix();
-
   return true;
 }
 
+bool Asteroid::IsExpired() const {
+  return age > 10.0f || position.y < -10;
+}
+
 void Asteroid::Explode(Scene &scene, glm::vec3 explPosition, glm::vec3 explScale, int pieces) {
   // Generate explosion
   auto explosion = ExplosionPtr(new Explosion{});
   explosion->position = explPosition;
   explosion->scale = explScale;
   explosion->speed = speed/2.0f;
-  scene.objects.push_back(explosion);
+  scene.Spawn(explosion);
 
   // Generate smaller asteroids
   for (int i = 0; i < pieces; i++) {
@@ -86,21 +117,13 @@ void Asteroid::Explode(Scene &scene, glm::vec3 explPosition, glm::vec3 explScale
     asteroid->rotMomentum = rotMomentum;
     float factor = (float)pieces/2.0f;
     asteroid->scale = scale / factor;
-    scene.objects.push_back(asteroid);
+    scene.Spawn(asteroid);
   }
 }
 
 void Asteroid::Render(Scene &scene) {
-  shader->Use();
-
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
-  // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
-  mesh->Render();
+  // Drawn by the render queue together with all objects sharing mesh and texture
+  scene.renderQueue.Submit(mesh, shader, texture, modelMatrix);
 }
 
 // shared resources
@@ -21,15 +21,28 @@ public:
   ~Asteroid();
 
   // Implement object interface
+  // Movement and the collision search run in Simulate, explosions are spawned in Update
+  void Simulate(const Scene &scene, float dt) override;
   bool Update(Scene &scene, float dt) override;
   void Render(Scene &scene) override;
+
+  // Adds an asteroid without collisions to the scene entities, it moves and rotates like an Asteroid object
+  static Entity CreateEntity(Scene &scene);
 private:
+  static void InitializeResources();
+
   // Generate explosion on position and scale, produce N smaller asteroid pieces
   void Explode(Scene &scene, glm::vec3 explPosition, glm::vec3 explScale, int pieces);
 
+  // Alive longer than 10s or out of visibility
+  bool IsExpired() const;
+
   // Age of the object in s
   float age;
 
+  // Asteroid collided with in the last Simulate
+  Asteroid *hit;
+
   // Speed and rotational momentum
   glm::vec3 speed;
   glm::vec3 rotMomentum;
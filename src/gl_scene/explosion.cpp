@@ -1,5 +1,6 @@
 #include "scene.h"
 #include "explosion.h"
+#include "resource_cache.h"
 
 #include "explosion_vert.h"
 #include "explosion_frag.h"
@@ -15,42 +16,18 @@ Explosion::Explosion() {
   speed = glm::vec3(0.0f);
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{explosion_vert, explosion_frag});
-  if (!texture) texture = TexturePtr(new Texture{"explosion.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "asteroid.obj"});
+  if (!shader) shader = ResourceCache::Get().GetShader(explosion_vert, explosion_frag);
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("explosion.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("asteroid.obj");
 }
 
 Explosion::~Explosion() {
 }
 
 void Explosion::Render(Scene &scene) {
-  shader->Use();
-
-  // Transparency, interpolate from 1.0f -> 0.0f
-  shader->SetFloat(1.0f-age/maxAge, "Transparency");
-
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
-  // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
-
-  // Disable depth testing
-  glDisable(GL_DEPTH_TEST);
-
-  // Enable blending
-  glEnable(GL_BLEND);
-  // Additive blending
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-
-  mesh->Render();
-
-  // Disable blending
-  glDisable(GL_BLEND);
-  // Enable depth test
-  glEnable(GL_DEPTH_TEST);
+  // Transparency, interpolate from 1.0f -> 0.0f, blended draws are sorted back to front
+  scene.renderQueue.Submit(mesh, shader, texture, modelMatrix, glm::vec4{1.0f-age/maxAge, 0.0f, 0.0f, 0.0f},
+                           RenderQueue::PASS_BLENDED);
 }
 
 bool Explosion::Update(Scene &scene, float dt) {
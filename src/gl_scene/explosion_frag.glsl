@@ -1,10 +1,10 @@
 #version 150
 // A texture is expected as program attribute
 uniform sampler2D Texture;
-uniform float Transparency;
 
 // The vertex shader fill feed this input
 in vec2 FragTexCoord;
+in float FragTransparency;
 
 // The final color
 out vec4 FragmentColor;
@@ -12,5 +12,5 @@ out vec4 FragmentColor;
 void main() {
   // Lookup the color in Texture on coordinates given by fragTexCoord
   FragmentColor = texture(Texture, FragTexCoord);
-  FragmentColor.a = Transparency;
+  FragmentColor.a = FragTransparency;
 }
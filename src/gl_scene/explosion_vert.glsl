@@ -3,18 +3,28 @@
 in vec3 Position;
 in vec2 TexCoord;
 
+// Per-instance inputs, transparency is stored in the first component of InstanceData
+in mat4 InstanceModelMatrix;
+in vec4 InstanceData;
+
 // This will be passed to the fragment shader
 out vec2 FragTexCoord;
+out float FragTransparency;
 
-// Matrices as program attributes
-uniform mat4 ProjectionMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ModelMatrix;
+// Camera data shared by all programs, uploaded once per frame
+layout(std140) uniform Camera {
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+  mat4 ViewProjectionMatrix;
+  vec4 CameraPosition;
+  float Time;
+};
 
 void main() {
   // Copy the input to the fragment shader
   FragTexCoord = TexCoord;
+  FragTransparency = InstanceData.x;
 
   // Calculate the final position on screen
-  gl_Position = ProjectionMatrix * ViewMatrix * ModelMatrix * vec4(Position, 1.0);
+  gl_Position = ViewProjectionMatrix * InstanceModelMatrix * vec4(Position, 1.0);
 }
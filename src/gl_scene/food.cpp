@@ -4,6 +4,7 @@
 
 #include "food.h"
 #include "scene.h"
+#include "resource_cache.h"
 
 #include "object_frag.h"
 #include "object_vert.h"
@@ -17,11 +18,14 @@ Food::Food() {
 
     scale *= 0.3f;
     isDead = false;
+    layer = LAYER_FOOD;
+    // Other food is removed within twice the scale
+    radius = 2.0f * scale.x;
 
     // Initialize static resources if needed
-    if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-    if (!texture) texture = TexturePtr(new Texture{"white.rgb", 512, 512});
-    if (!mesh) mesh = MeshPtr(new Mesh{shader, "food.obj"});
+    if (!shader) shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+    if (!texture) texture = ResourceCache::Get().GetTextureAsync("white.rgb", 512, 512);
+    if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("food.obj");
 
 }
 
@@ -30,50 +34,48 @@ Food::~Food() {
 
 bool Food::Update(Scene &scene, float dt) {
 
+    // Removed by other food, the destroy command is applied after the update pass
     if(isDead){
+        return true;
+    }
+
+    // Player picks the food up
+    bool eaten = false;
+    scene.collisions.Query(LAYER_PLAYER, position, 0.0f, [&](Object *obj) {
+        auto player = static_cast<Player *>(obj);
+        if(!eaten && glm::distance(position, player->position) < player->scale.z){
+            player->score++;
+            scene.numberOfFood--;
+            if(scene.verbose) printf("Score is %d\n", player->score);
+            eaten = true;
+        }
+    });
+    if(eaten){
         return false;
     }
 
-    for ( auto obj : scene.objects ) {
+    // Food spawned too close to other food removes it
+    scene.collisions.Query(LAYER_FOOD, position, 0.0f, [&](Object *obj) {
         // Ignore self in scene
-        if (obj.get() == this)
-            continue;
-
-        auto player = std::dynamic_pointer_cast<Player>(obj);
-        auto food = std::dynamic_pointer_cast<Food>(obj);
-        auto generator = std::dynamic_pointer_cast<Generator>(obj);
-        if(player){
-            if(glm::distance(position, player->position) < player->scale.z){
-                player->score++;
-                scene.numberOfFood--;
-                printf("Score is %d\n", player->score);
-                return false;
-            }
-        }
-        if(food){
-            if(glm::distance(position, food->position) < (food->scale.x)*2){
-                // destroy food a nie this
-                food->isDead = true;
-                scene.numberOfFood--;
-            }
+        if (obj == this)
+            return;
+
+        auto food = static_cast<Food *>(obj);
+        if(!food->isDead && glm::distance(position, food->position) < (food->scale.x)*2){
+            // destroy food a nie this
+            food->isDead = true;
+            scene.Destroy(food);
+            scene.numberOfFood--;
         }
-    }
+    });
 
     GenerateModelMatrix();
     return true;
 }
 
 void Food::Render(Scene &scene) {
-    shader->Use();
-
-    // use camera
-    shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-    shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
-    // render mesh
-    shader->SetMatrix(modelMatrix, "ModelMatrix");
-    shader->SetTexture(texture, "Texture");
-    mesh->Render();
+    // Drawn by the render queue together with all objects sharing mesh and texture
+    scene.renderQueue.Submit(mesh, shader, texture, modelMatrix);
 }
 
 // shared resources
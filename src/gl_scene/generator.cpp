@@ -11,7 +11,7 @@ bool Generator::Update(Scene &scene, float dt) {
     auto obj = FoodPtr(new Food());
     obj->position.x = Rand(-7.5f, 7.5f);
     obj->position.y = Rand(-5.0f, 7.5f);
-    scene.objects.push_back(obj);
+    scene.Spawn(obj);
     time = 0;
     scene.numberOfFood++;
   }
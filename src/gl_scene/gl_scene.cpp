@@ -4,31 +4,112 @@
 // - Creates a simple game scene with Player, Asteroid and World objects
 // - Contains a generator object that does not render but adds Asteroids to the scene
 // - Some objects use shared resources and all object deallocations are handled automatically
-// - Controls: LEFT, RIGHT, "R" to reset, SPACE to fire
+// - Controls: LEFT, RIGHT, "R" to reset, SPACE to fire, "I" to toggle instanced rendering, "C" to toggle frustum culling
+// - Run with --stress N to keep N asteroids in the scene and compare the single and instanced rendering paths
+// - Add --entities to keep the stress asteroids in the entity store instead of creating Asteroid objects
+// - Run with --threads N to simulate objects on N threads, 1 updates everything on the main thread
+// - Run with --seed N to get other random numbers, the same seed spawns the same objects
+// - The scene is simulated in fixed steps, --sim-rate HZ sets their rate and --render-rate HZ limits the frame rate
+// - Run with --frames N to benchmark N frames of one step each with scripted input, a JSON report is printed at the end
+//   or written to --json FILE, --headless renders to a hidden window and --no-gl only simulates without OpenGL
+//   The report has a hash of the final object state, runs with any number of --threads must report the same one
+//   All other messages of these runs go to stderr, so stdout has nothing but the report
+// - Run with --record FILE to log all input of the session, --replay FILE runs it again as a benchmark with the same
+//   seed and simulation rate, so the frame times of different builds can be compared
 
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cmath>
 #include <vector>
 #include <map>
 #include <list>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include "scene.h"
+#include "resource_cache.h"
+#include "gl_state.h"
+#include "fixed_timestep.h"
+#include "input_log.h"
 #include "camera.h"
 #include "generator.h"
+#include "asteroid.h"
 #include "player.h"
 #include "world.h"
 #include "wall.h"
 #include "food.h"
 
 const unsigned int SIZE = 900;
+// Seconds per frame that may be spent uploading loaded assets
+const double UPLOAD_BUDGET = 0.002;
+
+// Most simulation steps per frame, a slower frame slows the simulation down instead
+const unsigned int MAX_STEPS_PER_FRAME = 5;
+
+// Keys held in turn by the scripted player of benchmark runs, each one for a second of simulation
+const int SCRIPT_KEYS[] = {GLFW_KEY_LEFT, GLFW_KEY_UP, GLFW_KEY_RIGHT, GLFW_KEY_DOWN};
+
+// Frames measured per rendering path in stress mode before switching to the other one
+const int STRESS_FRAMES = 100;
 
 Scene scene;
 
+// Simulation steps per second and frames per second, 0 renders as fast as the swap interval allows
+double simulationRate = 60.0;
+double renderRate = 0.0;
+
+// Input recorded with --record or played back by --replay, events are stamped with the next simulation step
+InputLog inputLog;
+bool recording = false, replaying = false;
+uint32_t simulationStep = 0;
+
+// Messages and statistics of the game, benchmark runs print them to std::cerr so stdout only gets the JSON report
+std::ostream *messages = &std::cout;
+
+// Number of asteroids kept in the scene by --stress, 0 for the normal game
+unsigned int stressAsteroids = 0;
+// Stress asteroids are entities without collisions instead of objects
+bool stressEntities = false;
+
+// Keeps the requested number of asteroids in the scene, replacing the ones that left or exploded
+void SpawnStressAsteroids() {
+  size_t count = stressEntities ? scene.entities.Size() : scene.GetLayer(LAYER_ASTEROID).size();
+  if (count >= stressAsteroids) return;
+
+  // Positions of all missing asteroids in one batch
+  static std::vector<float> x, y;
+  x.resize(stressAsteroids - count);
+  y.resize(stressAsteroids - count);
+  auto &random = Object::GetRandom();
+  random.Fill(x.data(), x.size(), -10.0f, 10.0f);
+  random.Fill(y.data(), y.size(), -8.0f, 12.0f);
+
+  for (size_t j = 0; j < x.size(); j++) {
+    if (stressEntities) {
+      auto i = scene.entities.GetIndex(Asteroid::CreateEntity(scene));
+      scene.entities.position[i].x = x[j];
+      scene.entities.position[i].y = y[j];
+      scene.entities.scale[i] *= 0.2f;
+    } else {
+      auto asteroid = AsteroidPtr(new Asteroid{});
+      asteroid->position.x = x[j];
+      asteroid->position.y = y[j];
+      asteroid->scale *= 0.2f;
+      scene.Add(asteroid);
+    }
+  }
+}
+
 // Set up the scene
 void InitializeScene() {
-  scene.objects.clear();
+  scene.Clear();
 
   // Create a camera
   auto camera = CameraPtr(new Camera{ 60.0f, 1.0f, 0.1f, 100.0f});
@@ -37,130 +118,395 @@ void InitializeScene() {
 
   // Add space background
   auto world = WorldPtr(new World{});
-  scene.objects.push_back(world);
+  scene.Add(world);
 
   // Add generator to scene
   auto generator = GeneratorPtr(new Generator{});
-  scene.objects.push_back(generator);
+  scene.Add(generator);
 
     // Add player to the scene
     auto player = PlayerPtr(new Player{});
     player->position.y = -6;
-    scene.objects.push_back(player);
+    scene.Add(player);
 
     auto cube = WallPtr(new Wall());
     cube->position.y = 5;
-    scene.objects.push_back(cube);
+    scene.Add(cube);
 
     //Add walls to the scene
 //    auto wall1 = WallPtr(new Wall{});
 //    wall1->position.x = 5.0f;
-//    scene.objects.push_back(wall1);
+//    scene.Add(wall1);
 //
 //    auto wall2 = WallPtr(new Wall{});
 //    wall2->position.x = -5.0f;
-//    scene.objects.push_back(wall2);
+//    scene.Add(wall2);
 
 //    for(float x = 7.5f; x > -7.5f; x -= 1.5f){
 //        auto food = FoodPtr(new Food{});
 //        food->position.x = x;
 //        food->position.y = 7.5f;
-//        scene.objects.push_back(food);
+//        scene.Add(food);
 //    }
 
 }
 
 // Keyboard press event handler
 void OnKeyPress(GLFWwindow* /* window */, int key, int /* scancode */, int action, int /* mods */) {
+  if (recording) inputLog.RecordKey(simulationStep, key, action);
   scene.keyboard[key] = action;
 
   // Reset
   if (key == GLFW_KEY_R && action == GLFW_PRESS) {
     InitializeScene();
   }
+
+  // Switch between one draw call per object and instanced batches
+  if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+    scene.instancing = !scene.instancing;
+    *messages << "Instanced rendering " << (scene.instancing ? "on" : "off") << std::endl;
+  }
+
+  // Switch culling of objects outside of the camera view
+  if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+    scene.culling = !scene.culling;
+    *messages << "Frustum culling " << (scene.culling ? "on" : "off") << std::endl;
+  }
 }
 
 // Mouse move event handler
 void OnMouseMove(GLFWwindow* /* window */, double xpos, double ypos) {
+  if (recording) inputLog.RecordMouseMove(simulationStep, xpos, ypos);
   scene.mouse.x = xpos;
   scene.mouse.y = ypos;
 }
 
-int main() {
-  // Initialize GLFW
-  if (!glfwInit()) {
-    std::cerr << "Failed to initialize GLFW!" << std::endl;
-    return EXIT_FAILURE;
+// Seconds on a monotonic clock, also available when GLFW is not initialized
+double Now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Input of benchmark runs, the same on every run
+void ScriptInput(unsigned int frame) {
+  auto length = std::max(1u, (unsigned int) simulationRate);
+  if (frame % length != 0) return;
+  auto segment = frame / length;
+  auto keys = sizeof(SCRIPT_KEYS) / sizeof(SCRIPT_KEYS[0]);
+  if (segment > 0) OnKeyPress(nullptr, SCRIPT_KEYS[(segment - 1) % keys], 0, GLFW_RELEASE, 0);
+  OnKeyPress(nullptr, SCRIPT_KEYS[segment % keys], 0, GLFW_PRESS, 0);
+}
+
+// Feeds a recorded event through the handlers of live input
+void ReplayEvent(const InputLog::Event &event) {
+  if (event.type == InputLog::EVENT_KEY)
+    OnKeyPress(nullptr, event.key, 0, event.action, 0);
+  else
+    OnMouseMove(nullptr, event.x, event.y);
+}
+
+// Mean, nearest rank percentiles and maximum of per frame times in s as a JSON object in ms
+void WriteTimes(std::ostream &out, std::vector<double> times) {
+  if (times.empty()) times.push_back(0.0);
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (auto t : times) sum += t;
+  auto percentile = [&times](double p) {
+    auto rank = (size_t) std::ceil(p * (double) times.size());
+    return times[rank > 0 ? rank - 1 : 0] * 1000.0;
+  };
+  out << "{\"mean\": " << sum / (double) times.size() * 1000.0 << ", \"p50\": " << percentile(0.5)
+      << ", \"p90\": " << percentile(0.9) << ", \"p99\": " << percentile(0.99)
+      << ", \"max\": " << times.back() * 1000.0 << "}";
+}
+
+int main(int argc, char *argv[]) {
+  // Benchmark run options
+  unsigned int benchmarkFrames = 0;
+  bool headless = false, graphics = true;
+  std::string jsonFile, recordFile;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--stress") == 0)
+      stressAsteroids = i + 1 < argc ? (unsigned int) atoi(argv[++i]) : 10000;
+    if (strcmp(argv[i], "--entities") == 0)
+      stressEntities = true;
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      scene.seed = strtoull(argv[++i], nullptr, 10);
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      scene.jobs.SetThreadCount((unsigned int) atoi(argv[++i]));
+    if (strcmp(argv[i], "--sim-rate") == 0 && i + 1 < argc)
+      simulationRate = atof(argv[++i]);
+    if (strcmp(argv[i], "--render-rate") == 0 && i + 1 < argc)
+      renderRate = atof(argv[++i]);
+    if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+      benchmarkFrames = (unsigned int) atoi(argv[++i]);
+    if (strcmp(argv[i], "--headless") == 0)
+      headless = true;
+    if (strcmp(argv[i], "--no-gl") == 0)
+      headless = true, graphics = false;
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+      jsonFile = argv[++i];
+    if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+      recordFile = argv[++i], recording = true;
+    if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      if (!inputLog.Load(argv[++i])) return EXIT_FAILURE;
+      replaying = true;
+    }
   }
 
-  // Setup OpenGL context
-  glfwWindowHint(GLFW_SAMPLES, 4);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-  // Try to create a window
-  auto window = glfwCreateWindow(SIZE, SIZE, "PPGSO gl_scene", nullptr, nullptr);
-  if (!window) {
-    std::cerr << "Failed to open GLFW window, your graphics card is probably only capable of OpenGL 2.1" << std::endl;
-    glfwTerminate();
-    return EXIT_FAILURE;
+  // The replay simulates the recorded steps under the recorded conditions, unless fewer --frames are asked for
+  if (replaying) {
+    scene.seed = inputLog.seed;
+    simulationRate = inputLog.stepRate;
+    if (!benchmarkFrames) benchmarkFrames = inputLog.stepCount;
+    if (!benchmarkFrames) {
+      std::cerr << "The input log has no steps to replay" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (recording) {
+    // A replay would only record the same log again
+    if (replaying) {
+      std::cerr << "--record and --replay can not be combined" << std::endl;
+      return EXIT_FAILURE;
+    }
+    inputLog.seed = scene.seed;
+    inputLog.stepRate = simulationRate;
   }
 
-  // Finalize window setup
-  glfwMakeContextCurrent(window);
+  // Objects stay quiet in benchmark runs, printing in the update would be measured with it
+  if (benchmarkFrames) {
+    messages = &std::cerr;
+    scene.verbose = false;
+  }
 
-  // Initialize GLEW
-  glewExperimental = GL_TRUE;
-  glewInit();
-  if (!glewIsSupported("GL_VERSION_3_3")) {
-    std::cerr << "Failed to initialize GLEW with OpenGL 3.3!" << std::endl;
-    glfwTerminate();
+  // Nobody could close a window that is not shown
+  if (headless && !benchmarkFrames) {
+    std::cerr << "--headless and --no-gl need the number of --frames to run" << std::endl;
     return EXIT_FAILURE;
   }
 
-  // Add keyboard and mouse handlers
-  glfwSetKeyCallback(window, OnKeyPress);
-  glfwSetCursorPosCallback(window, OnMouseMove);
-  glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN); // Hide mouse cursor
-  glfwSetInputMode(window, GLFW_STICKY_KEYS, 1);
+  GLFWwindow *window = nullptr;
+  if (graphics) {
+    // Initialize GLFW
+    if (!glfwInit()) {
+      std::cerr << "Failed to initialize GLFW!" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Setup OpenGL context
+    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Headless runs render into the default framebuffer of a hidden window
+    // Machines without a GPU provide the context with Mesa llvmpipe, under X11 on a virtual display such as Xvfb
+    if (headless) glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    // Try to create a window
+    window = glfwCreateWindow(SIZE, SIZE, "PPGSO gl_scene", nullptr, nullptr);
+    if (!window) {
+      std::cerr << "Failed to open GLFW window, your graphics card is probably only capable of OpenGL 2.1" << std::endl;
+      glfwTerminate();
+      return EXIT_FAILURE;
+    }
+
+    // Finalize window setup
+    glfwMakeContextCurrent(window);
+    // Benchmark frames are not held back by the display refresh
+    if (benchmarkFrames) glfwSwapInterval(0);
+
+    // Initialize GLEW
+    glewExperimental = GL_TRUE;
+    glewInit();
+    if (!glewIsSupported("GL_VERSION_3_3")) {
+      std::cerr << "Failed to initialize GLEW with OpenGL 3.3!" << std::endl;
+      glfwTerminate();
+      return EXIT_FAILURE;
+    }
+
+    // Add keyboard and mouse handlers, a replay takes all input from the log
+    if (!replaying) {
+      glfwSetKeyCallback(window, OnKeyPress);
+      glfwSetCursorPosCallback(window, OnMouseMove);
+    }
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN); // Hide mouse cursor
+    glfwSetInputMode(window, GLFW_STICKY_KEYS, 1);
+
+    // Initialize OpenGL state
+    // Enable Z-buffer
+    GLState::Get().SetDepthTest(true);
+    glDepthFunc(GL_LEQUAL);
+
+    // Enable polygon culling
+    GLState::Get().SetCullFace(true);
+    glFrontFace(GL_CCW);
+    glCullFace(GL_BACK);
+
+    // Start loading all assets in the background, objects get placeholders until their data is uploaded
+    ResourceCache::Get().PreloadManifest("gl_scene.manifest");
+  } else {
+    // Simulation only, objects get no meshes, textures and shaders
+    ResourceCache::Get().DisableGraphics();
+  }
 
-  // Initialize OpenGL state
-  // Enable Z-buffer
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LEQUAL);
+  InitializeScene();
 
-  // Enable polygon culling
-  glEnable(GL_CULL_FACE);
-  glFrontFace(GL_CCW);
-  glCullFace(GL_BACK);
+  // Benchmark frames all draw the complete assets
+  if (graphics && benchmarkFrames) ResourceCache::Get().FinishLoading();
 
-  InitializeScene();
+  // Track time, the simulation advances in fixed steps and rendering blends the last two of them
+  FixedTimestep timestep{simulationRate, MAX_STEPS_PER_FRAME};
+  double time = Now();
 
-  // Track time
-  float time = (float)glfwGetTime();
+  // Benchmark statistics of every frame
+  std::vector<double> frameTimes, updateTimes, renderTimes;
+  size_t maxObjects = 0;
+
+  // Stress mode statistics of the current rendering path
+  int stressFrame = 0;
+  size_t stressDraws = 0, stressVisible = 0, stressCulled = 0, stressSteps = 0;
+  double stressUpdateTime = 0.0, stressRenderTime = 0.0, stressCullTime = 0.0, stressSortTime = 0.0;
 
   // Main execution loop
-  while (!glfwWindowShouldClose(window)) {
-    // Compute time delta
-    float dt = (float)glfwGetTime() - time;
-    time = (float)glfwGetTime();
-
-    // Set gray background
-    glClearColor(.5f,.5f,.5f,0);
-    // Clear depth and color buffers
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // Update and render all objects
-    scene.Update(dt);
-    scene.Render();
-
-    // Display result
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+  for (unsigned int frame = 0; benchmarkFrames ? frame < benchmarkFrames : !glfwWindowShouldClose(window); frame++) {
+    // Compute time delta, benchmark runs simulate exactly one step per frame so every run does the same work
+    double frameStart = Now();
+    unsigned int steps = timestep.Advance(benchmarkFrames ? timestep.GetStep() : frameStart - time);
+    time = frameStart;
+    if (benchmarkFrames && !replaying) ScriptInput(frame);
+
+    if (graphics) {
+      // Set gray background
+      glClearColor(.5f,.5f,.5f,0);
+      // Clear depth and color buffers
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Update and render all objects, CPU time of both is measured for the stress report
+    double updateStart = Now();
+    for (unsigned int step = 0; step < steps; step++) {
+      // Recorded events are applied before the step they were recorded at, as they were in the live session
+      if (replaying) inputLog.Replay(simulationStep, ReplayEvent);
+      if (stressAsteroids) SpawnStressAsteroids();
+      scene.Update((float) timestep.GetStep());
+      simulationStep++;
+    }
+    double renderStart = Now();
+    if (graphics) scene.Render(timestep.GetAlpha());
+    double renderEnd = Now();
+
+    if (graphics) {
+      // Upload assets finished by the background loader, limited so a frame never stalls
+      auto uploads = ResourceCache::Get().ProcessUploads(UPLOAD_BUDGET);
+      if (uploads.uploads > 0) {
+        *messages << "Uploaded " << uploads.uploads << " assets, " << uploads.bytes / 1024 << " kB in "
+                  << uploads.time * 1000.0 << " ms, " << uploads.pending << " pending" << std::endl;
+      }
+
+      // Close the redundant state change statistics of this frame
+      auto frameStats = GLState::Get().EndFrame();
+
+      // Report the average of the current rendering path and switch to the other one
+      if (stressAsteroids) {
+        stressDraws += frameStats.draws;
+        stressSteps += steps;
+        auto &queueStats = scene.renderQueue.GetStats();
+        stressVisible += queueStats.visible;
+        stressCulled += queueStats.culled;
+        stressCullTime += queueStats.cull_time;
+        stressSortTime += queueStats.sort_time;
+        stressUpdateTime += renderStart - updateStart;
+        stressRenderTime += renderEnd - renderStart;
+        if (++stressFrame == STRESS_FRAMES) {
+          *messages << (scene.instancing ? "instanced" : "single   ") << ": " << scene.objects.size() << " objects on "
+                    << scene.jobs.GetThreadCount() << " threads, "
+                    << scene.entities.Size() << " entities, "
+                    << stressVisible / STRESS_FRAMES << " visible, " << stressCulled / STRESS_FRAMES << " culled, "
+                    << stressDraws / STRESS_FRAMES << " draw calls, "
+                    << (double) stressSteps / STRESS_FRAMES << " steps, update "
+                    << stressUpdateTime * 1000.0 / STRESS_FRAMES << " ms, render "
+                    << stressRenderTime * 1000.0 / STRESS_FRAMES << " ms (cull "
+                    << stressCullTime * 1000.0 / STRESS_FRAMES << " ms, sort "
+                    << stressSortTime * 1000.0 / STRESS_FRAMES << " ms) per frame" << std::endl;
+          scene.instancing = !scene.instancing;
+          stressFrame = 0;
+          stressDraws = stressVisible = stressCulled = stressSteps = 0;
+          stressUpdateTime = stressRenderTime = stressCullTime = stressSortTime = 0.0;
+        }
+      }
+
+      // Display result
+      glfwSwapBuffers(window);
+      glfwPollEvents();
+    }
+
+    // Wait for the next frame when the frame rate is limited
+    if (renderRate > 0.0) {
+      double wait = frameStart + 1.0 / renderRate - Now();
+      if (wait > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
+
+    if (benchmarkFrames) {
+      frameTimes.push_back(Now() - frameStart);
+      updateTimes.push_back(renderStart - updateStart);
+      renderTimes.push_back(renderEnd - renderStart);
+      maxObjects = std::max(maxObjects, scene.objects.size());
+    }
+  }
+
+  // Machine readable report of the benchmark run
+  if (benchmarkFrames) {
+    std::ofstream file;
+    if (!jsonFile.empty()) {
+      file.open(jsonFile);
+      if (!file.is_open()) std::cerr << "Could not write " << jsonFile << std::endl;
+    }
+    std::ostream &out = file.is_open() ? file : std::cout;
+    out << "{\"frames\": " << benchmarkFrames
+        << ", \"mode\": \"" << (!graphics ? "simulation" : headless ? "hidden" : "window") << "\""
+        << ", \"input\": \"" << (replaying ? "replay" : "script") << "\""
+        << ", \"threads\": " << scene.jobs.GetThreadCount() << ", \"seed\": " << scene.seed
+        << ", \"sim_rate\": " << timestep.GetStepRate() << ", \"steps\": " << timestep.GetStats().total_steps
+        << ", \"objects\": " << scene.objects.size() << ", \"max_objects\": " << maxObjects
+        << ", \"entities\": " << scene.entities.Size() << ", \"state\": \"" << std::hex << scene.GetStateHash()
+        << std::dec << "\",\n \"frame_ms\": ";
+    WriteTimes(out, frameTimes);
+    out << ",\n \"update_ms\": ";
+    WriteTimes(out, updateTimes);
+    out << ",\n \"render_ms\": ";
+    WriteTimes(out, renderTimes);
+    out << "}" << std::endl;
+  }
+
+  if (recording) {
+    inputLog.stepCount = simulationStep;
+    if (inputLog.Save(recordFile))
+      *messages << "Recorded " << inputLog.GetEvents().size() << " input events in " << simulationStep << " steps to "
+                << recordFile << std::endl;
+  }
+
+  if (!graphics) {
+    scene.Clear();
+    return EXIT_SUCCESS;
   }
 
+  // Report shared resources, then release the ones no object holds while the OpenGL context still exists
+  scene.Clear();
+  ResourceCache::Get().PrintStats(*messages);
+  auto state = GLState::Get().GetTotalStats();
+  auto frames = std::max<size_t>(GLState::Get().GetFrameCount(), 1);
+  *messages << "GL state changes per frame: " << state.issued / frames << " issued, "
+            << state.skipped / frames << " skipped, " << state.draws / frames << " draw calls" << std::endl;
+  ResourceCache::Get().EvictUnused();
+  auto &simulation = timestep.GetStats();
+  auto simulationFrames = std::max<uint64_t>(simulation.frames, 1);
+  *messages << "Simulation: " << simulation.total_steps << " steps of " << timestep.GetStep() * 1000.0 << " ms in "
+            << simulation.frames << " frames, " << (double) simulation.total_steps / (double) simulationFrames
+            << " steps per frame, " << simulation.capped_frames << " frames over the limit of " << MAX_STEPS_PER_FRAME
+            << " steps dropped " << simulation.dropped_time << " s" << std::endl;
+
   // Clean up
   glfwTerminate();
 
@@ -1,26 +1,71 @@
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/euler_angles.hpp>
+#include <algorithm>
+#include <limits>
+
+#include <glm/common.hpp>
 
 #include "object.h"
+#include "transform.h"
 
 Object::Object() {
   position = glm::vec3(0,0,0);
   scale = glm::vec3(1,1,1);
   rotation = glm::vec3(0,0,0);
   modelMatrix = glm::mat4(1.0f);
-
+  radius = 0.0f;
+  layer = LAYER_NONE;
+  layerIndex = 0;
+  collisionId = (size_t) -1;
+  destroyed = false;
+  snapshotPosition = position;
+  snapshotScale = scale;
+  // NaN never compares equal, the first GenerateModelMatrix always runs
+  matrixPosition = matrixRotation = matrixScale = glm::vec3(std::numeric_limits<float>::quiet_NaN());
+  StorePreviousState();
 }
 
 Object::~Object() {
 }
 
 void Object::GenerateModelMatrix() {
-  modelMatrix =
-          glm::translate(glm::mat4(1.0f), position)
-          * glm::orientate4(rotation)
-          * glm::scale(glm::mat4(1.0f), scale);
+  // Static objects such as walls keep their matrix
+  if (position == matrixPosition && rotation == matrixRotation && scale == matrixScale) return;
+  matrixPosition = position;
+  matrixRotation = rotation;
+  matrixScale = scale;
+
+  // Same as translate(position) * orientate4(rotation) * scale(scale) without the matrix products
+  modelMatrix = ComposeTransform(position, rotation, scale);
+}
+
+float Object::GetCollisionRadius() const {
+  return std::max(radius, std::max(scale.x, std::max(scale.y, scale.z)));
+}
+
+void Object::StorePreviousState() {
+  previousPosition = position;
+  previousRotation = rotation;
+  previousScale = scale;
+}
+
+void Object::Interpolate(float alpha) {
+  // Objects that did not move in the last step are drawn as they are, blending would only add rounding
+  glm::vec3 p = position, r = rotation, s = scale;
+  if (previousPosition != position) p = glm::mix(previousPosition, position, alpha);
+  if (previousRotation != rotation) r = glm::mix(previousRotation, rotation, alpha);
+  if (previousScale != scale) s = glm::mix(previousScale, scale, alpha);
+  if (p == matrixPosition && r == matrixRotation && s == matrixScale) return;
+
+  matrixPosition = p;
+  matrixRotation = r;
+  matrixScale = s;
+  modelMatrix = ComposeTransform(p, r, s);
+}
+
+Random &Object::GetRandom() {
+  static thread_local Random random;
+  return random;
 }
 
 float Object::Rand(float min, float max) {
-  return ((max - min) * ((float) rand() / (float) RAND_MAX)) + min;
+  return GetRandom().Float(min, max);
 }
@@ -2,6 +2,7 @@
 #define PPGSO_OBJECT_H
 
 #include <memory>
+#include <cstddef>
 #include <list>
 #include <map>
 
@@ -9,11 +10,23 @@
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/detail/type_vec3.hpp>
 
+#include "random.h"
+
 #define PI 3.14159265358979323846f
 
 // Forward declare a scene
 class Scene;
 
+// Collision layers of the scene spatial hash, each object class has its own so queries visit only one kind
+enum ObjectLayer {
+  LAYER_NONE = 0,
+  LAYER_PLAYER,
+  LAYER_ASTEROID,
+  LAYER_FOOD,
+  LAYER_WALL,
+  LAYER_COUNT
+};
+
 // Abstract scene object interface
 // All objects in the scene should be able to Update and Render
 // Generally we also want to keep position, rotation and scale for each object to generate a modelMatrix
@@ -22,8 +35,13 @@ public:
   Object();
   virtual ~Object();
 
+  // Optional parallel part of the update, runs for all objects on the scene jobs before any Update
+  // It may only change the object itself and reads other objects through their snapshot, never their properties
+  virtual void Simulate(const Scene &scene, float dt) {}
+
   // Primary interface Update should update the objects modelMatrix and return true
   // If update returns false than the object will be removed from the scene
+  // Runs after all Simulate calls, one object after another in scene order
   virtual bool Update(Scene &scene, float dt) = 0;
 
   // Render needs to gernerate geometry using the modelMatrix and camera from scene
@@ -35,12 +53,46 @@ public:
   glm::vec3 scale;
   glm::mat4 modelMatrix;
   float radius;
+  // Set in the constructor and never changed, the scene registers the object by it
+  ObjectLayer layer;
+  // Bookkeeping of the scene layer registry and collision grid
+  size_t layerIndex;
+  size_t collisionId;
+  // Set by the scene when a destroy command is applied, the object is removed right after
+  bool destroyed;
+  // Position and scale at the start of the frame, taken for objects with a layer when the collision grid is built
+  glm::vec3 snapshotPosition;
+  glm::vec3 snapshotScale;
+
+  // Distance within which other objects can collide with this one, the larger of radius and scale
+  float GetCollisionRadius() const;
+
+  // Keeps position, rotation and scale at the start of a simulation step
+  void StorePreviousState();
+  // Sets modelMatrix to the properties blended from the start of the last step by alpha for rendering between steps
+  // The next GenerateModelMatrix restores the matrix of the current properties
+  void Interpolate(float alpha);
+
+  // Generator behind Rand, one per thread, Scene::Clear reseeds the one of its thread from Scene::seed
+  // Clear and Update run on the main thread, so all Rand calls of Update draw from the reseeded generator
+  // Simulate runs on other threads and must not use it
+  static Random &GetRandom();
 
 protected:
-  // Generate modelMatrix from properties
+  // Generate modelMatrix from properties, skipped when they did not change since the last call
   void GenerateModelMatrix();
   // Random float generator
-  float Rand(float min, float max);
+  static float Rand(float min, float max);
+
+private:
+  // Properties at the start of the last simulation step
+  glm::vec3 previousPosition;
+  glm::vec3 previousRotation;
+  glm::vec3 previousScale;
+  // Properties the current modelMatrix was generated from
+  glm::vec3 matrixPosition;
+  glm::vec3 matrixRotation;
+  glm::vec3 matrixScale;
 };
 typedef std::shared_ptr<Object> ObjectPtr;
 
@@ -4,24 +4,31 @@ in vec3 Position;
 in vec2 TexCoord;
 in vec3 Normal;
 
+// Per-instance inputs, filled from the draw packets of the render queue
+in mat4 InstanceModelMatrix;
+
 // This will be passed to the fragment shader
 out vec2 FragTexCoord;
 
 // Normal to pass to the fragment shader
 out vec4 normal;
 
-// Matrices as program attributes
-uniform mat4 ProjectionMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ModelMatrix;
+// Camera data shared by all programs, uploaded once per frame
+layout(std140) uniform Camera {
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+  mat4 ViewProjectionMatrix;
+  vec4 CameraPosition;
+  float Time;
+};
 
 void main() {
   // Copy the input to the fragment shader
   FragTexCoord = TexCoord;
 
   // Normal in world coordinates
-  normal = normalize(ModelMatrix * vec4(Normal, 0.0f));
+  normal = normalize(InstanceModelMatrix * vec4(Normal, 0.0f));
 
   // Calculate the final position on screen
-  gl_Position = ProjectionMatrix * ViewMatrix * ModelMatrix * vec4(Position, 1.0);
+  gl_Position = ViewProjectionMatrix * InstanceModelMatrix * vec4(Position, 1.0);
 }
@@ -1,5 +1,6 @@
 #include "player.h"
 #include "scene.h"
+#include "resource_cache.h"
 #include "object_frag.h"
 #include "object_vert.h"
 #include "wall.h"
@@ -16,11 +17,12 @@ Player::Player() {
 
     score = 0;
     radius = .9135f * scale.y;
+    layer = LAYER_PLAYER;
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-  if (!texture) texture = TexturePtr(new Texture{"pacman.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "pacman.obj"});
+  if (!shader) shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("pacman.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("pacman.obj");
 }
 
 Player::~Player() {
@@ -34,15 +36,19 @@ bool Player::Update(Scene &scene, float dt) {
             position.x += 10 * dt;
         }
         rotation.y = PI/0.5f;
-      printf("Position X is %f\n", position.x);
-      printf("Position Y is %f\n", position.y);
+      if(scene.verbose) {
+        printf("Position X is %f\n", position.x);
+        printf("Position Y is %f\n", position.y);
+      }
     } else if(scene.keyboard[GLFW_KEY_RIGHT] && position.x > -7.5f) {
         if(CollisionDetection(scene)){
             position.x -= 10 * dt;
         }
         rotation.y = PI;
-      printf("Position X is %f\n", position.x);
-      printf("Position Y is %f\n", position.y);
+      if(scene.verbose) {
+        printf("Position X is %f\n", position.x);
+        printf("Position Y is %f\n", position.y);
+      }
     } else if(scene.keyboard[GLFW_KEY_UP] && position.y <= 7.5f) {
         position.y += 10 * dt;
         rotation.y = PI/2.0f;
@@ -60,31 +66,21 @@ bool Player::Update(Scene &scene, float dt) {
 }
 
 bool Player::CollisionDetection(Scene &scene){
-    for ( auto obj : scene.objects ) {
-        if (obj.get() == this)
-            continue;
-
-        auto wall = std::dynamic_pointer_cast<Wall>(obj);
-        if(wall){
-            if(glm::distance(position, wall->position) < (wall->radius + radius)){
-                return false;
-            }
+    bool blocked = false;
+    scene.collisions.Query(LAYER_WALL, position, radius, [&](Object *wall) {
+        if(glm::distance(position, wall->position) < (wall->radius + radius)){
+            blocked = true;
         }
+    });
+    if(blocked){
+        return false;
     }
     return true;
 }
 
 void Player::Render(Scene &scene) {
-  shader->Use();
-
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
-  // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
-  mesh->Render();
+  // Drawn by the render queue together with all objects sharing mesh and texture
+  scene.renderQueue.Submit(mesh, shader, texture, modelMatrix);
 }
 
 // shared resources
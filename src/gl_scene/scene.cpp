@@ -1,32 +1,165 @@
+#include <cstring>
+
 #include "scene.h"
 #include "generator.h"
 
-Scene::Scene() {
+// Cell size of the collision grid, about twice the collision radius of the larger objects
+const float COLLISION_CELL_SIZE = 2.0f;
+// Offset basis and prime of the 64 bit FNV-1a hash
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+// Adds the bytes of a value to the hash, floats are hashed by their bits so any difference shows
+template<typename T>
+static void HashBytes(uint64_t &hash, const T &value) {
+  unsigned char bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  for (auto byte : bytes) hash = (hash ^ byte) * FNV_PRIME;
+}
+
+// Objects processed by one job, small enough to balance the load and large enough to hide the scheduling cost
+const size_t OBJECTS_PER_JOB = 256;
+
+Scene::Scene() : collisions{COLLISION_CELL_SIZE, LAYER_COUNT}, layers{LAYER_COUNT} {
+    time = 0;
+    instancing = true;
+    culling = true;
     numberOfFood = 0;
+    seed = 0;
+    verbose = true;
 }
 
 Scene::~Scene() {
 }
 
 void Scene::Update(float time) {
+  this->time += time;
   camera->Update();
 
-  // Use iterator to update all objects so we can remove while iterating
-  auto i = std::begin(objects);
+  // Start of the step for interpolated rendering
+  for (auto &obj : objects) obj->StorePreviousState();
+
+  // Broad phase of all objects with a layer, their snapshot is what the Simulate phase sees of them
+  collisions.Clear();
+  for (unsigned int layer = LAYER_NONE + 1; layer < LAYER_COUNT; layer++)
+    for (auto obj : layers.Get(layer)) {
+      obj->snapshotPosition = obj->position;
+      obj->snapshotScale = obj->scale;
+      obj->collisionId = collisions.Insert(layer, obj->position, obj->GetCollisionRadius(), obj);
+    }
+  collisions.Build();
+
+  // Simulate all objects in parallel, each one changes only itself
+  jobs.ParallelFor(objects.size(), OBJECTS_PER_JOB, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) objects[i]->Simulate(*this, time);
+  });
 
-  while (i != std::end(objects)) {
-    // Update and remove from list if needed
-    auto obj = i->get();
-    if (!obj->Update(*this, time))
-        i = objects.erase(i); // NOTE: no need to call destructors as we store shared pointers in the scene
-    else
-        ++i;
+  // Update all objects in order, the objects vector does not change until the commands are applied
+  for (size_t i = 0; i < objects.size(); i++) {
+    auto obj = objects[i].get();
+    if (!obj->Update(*this, time)) {
+      // Hidden from the collision queries of the objects updated after it
+      if (obj->layer != LAYER_NONE) collisions.Remove(obj->collisionId);
+      Destroy(obj);
+    }
   }
+
+  // Sync point, spawned objects are updated from the next frame
+  ApplyCommands();
+
+  // Entity systems, entities leave the scene like asteroids do
+  entities.Integrate(time);
+  entities.DestroyIf([](const EntityStore &store, size_t i) {
+    return store.age[i] > store.lifetime[i] || store.position[i].y < -10;
+  });
+  entities.UpdateModelMatrices();
 }
 
-void Scene::Render() {
-  // Simply render all objects
+void Scene::Render(float alpha) {
+  // Camera matrices are shared by all objects, upload them once per frame
+  camera->Upload(time);
+  renderQueue.SetViewPosition(camera->position);
+  renderQueue.SetFrustum(culling ? camera->frustum : Frustum{});
+
+  // Each object changes only its own matrix
+  jobs.ParallelFor(objects.size(), OBJECTS_PER_JOB, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) objects[i]->Interpolate(alpha);
+  });
+
+  // Collect draw packets of all objects, then sort and draw them
   for (auto obj : objects )
     obj->Render(*this);
+  entities.Submit(renderQueue);
+  renderQueue.Execute(instancing);
+}
+
+void Scene::Add(const ObjectPtr &obj) {
+  // Not moving until its first step
+  obj->StorePreviousState();
+  objects.push_back(obj);
+  if (obj->layer != LAYER_NONE) layers.Add(obj.get());
+}
+
+void Scene::Spawn(const ObjectPtr &obj) {
+  commands.Record({obj, nullptr});
+}
+
+void Scene::Destroy(Object *obj) {
+  commands.Record({nullptr, obj});
+}
+
+void Scene::ApplyCommands() {
+  bool removed = false;
+  commands.Apply([&](const Command &command) {
+    if (command.spawn) Add(command.spawn);
+    if (command.destroy && !command.destroy->destroyed) {
+      command.destroy->destroyed = true;
+      removed = true;
+    }
+  });
+  if (!removed) return;
+
+  // Remove destroyed objects in one pass keeping the order of the others
+  // NOTE: no need to call destructors as we store shared pointers in the scene
+  size_t kept = 0;
+  for (size_t i = 0; i < objects.size(); i++) {
+    auto obj = objects[i].get();
+    if (obj->destroyed) {
+      if (obj->layer != LAYER_NONE) layers.Remove(obj);
+      continue;
+    }
+    if (kept != i) objects[kept] = std::move(objects[i]);
+    kept++;
+  }
+  objects.resize(kept);
 }
 
+void Scene::Clear() {
+  commands.Clear();
+  objects.clear();
+  entities.Clear();
+  layers.Clear();
+  collisions.Clear();
+  Object::GetRandom().Seed(seed);
+}
+
+const std::vector< Object * > &Scene::GetLayer(ObjectLayer layer) const {
+  return layers.Get(layer);
+}
+
+uint64_t Scene::GetStateHash() const {
+  uint64_t hash = FNV_OFFSET;
+  HashBytes(hash, (uint64_t) objects.size());
+  for (auto &obj : objects) {
+    HashBytes(hash, obj->position);
+    HashBytes(hash, obj->rotation);
+    HashBytes(hash, obj->scale);
+  }
+  HashBytes(hash, (uint64_t) entities.Size());
+  for (size_t i = 0; i < entities.Size(); i++) {
+    HashBytes(hash, entities.position[i]);
+    HashBytes(hash, entities.rotation[i]);
+    HashBytes(hash, entities.scale[i]);
+  }
+  return hash;
+}
@@ -3,26 +3,73 @@
 
 #include <memory>
 #include <map>
-#include <list>
+#include <vector>
 
 #include "object.h"
 #include "camera.h"
+#include "render_queue.h"
+#include "spatial_hash.h"
+#include "layer_registry.h"
+#include "entity_store.h"
+#include "command_buffer.h"
+#include "job_system.h"
 
 // Simple object that contains all scene related data
-// Object pointers are stored in a list of objects
+// Object pointers are stored in a vector of objects, objects with a layer are also kept in per layer registries
+// Objects spawned and destroyed during Update are recorded as commands and applied after all objects were updated
+// Update runs in two phases, the parallel Simulate of all objects on the jobs and then the serial Update
+// Simple moving objects without own behavior can be entities, they are updated and rendered by systems
 // Keyboard and Mouse states are stored in a map and struct
 class Scene {
   public:
     Scene();
     ~Scene();
 
-    // Animate all objects in scene
+    // Animate all objects in scene by one simulation step
     void Update(float time);
-    // Render all objects in scene
-    void Render();
+    // Render all objects in scene, alpha is the fraction of a step passed since the last Update
+    // Objects are drawn blended between their state before and after that step
+    void Render(float alpha = 1.0f);
+
+    // Adds an object to the objects and to the registry of its layer, do not push to objects directly
+    // Only outside of Update, objects spawned while updating use Spawn
+    void Add(const ObjectPtr &obj);
+    // Records an object to add after the update pass, safe to call from any thread during Update
+    void Spawn(const ObjectPtr &obj);
+    // Records an object to remove after the update pass, safe to call from any thread during Update
+    // Destroying an object more than once in a frame removes it once
+    void Destroy(Object *obj);
+    // Removes all objects and restarts the random numbers of Object::Rand from the seed
+    void Clear();
+    // All objects of a layer in no particular order, valid until objects are added or removed
+    const std::vector< Object * > &GetLayer(ObjectLayer layer) const;
+    // FNV-1a hash of the order, position, rotation and scale of all objects and entities
+    // Equal for runs that simulated the same state, whatever the number of threads
+    uint64_t GetStateHash() const;
+
+    // Time since the scene was created in s, shaders get it through the camera uniform block
+    float time;
+
+    // Runs started by Clear with the same seed spawn the same objects, given the same input and frame times
+    uint64_t seed;
+
+    // Objects submit their draws here in Render, runs sharing mesh, shader and texture
+    // are merged into one instanced call when instancing is enabled
+    bool instancing;
+    // Objects outside of the camera frustum are skipped by the render queue when culling is enabled
+    bool culling;
+    RenderQueue renderQueue;
+
+    // Threads running the Simulate phase and the interpolation of matrices, results do not depend on their number
+    JobSystem jobs;
+
+    // Objects with a layer, rebuilt at the start of Update from the positions of the previous frame
+    // Objects removed during Update are hidden, objects added during Update are found from the next frame
+    SpatialHash< Object * > collisions;
 
     CameraPtr camera;
-    std::list< ObjectPtr > objects;
+    std::vector< ObjectPtr > objects;
+    EntityStore entities;
     std::map< int, int > keyboard;
     struct {
       double x, y;
@@ -30,6 +77,21 @@ class Scene {
     } mouse;
 
     int numberOfFood;
+
+    // Objects print game events such as the score to stdout, benchmark runs turn it off
+    bool verbose;
+
+  private:
+    // Applies the spawn and destroy commands recorded during the update pass
+    void ApplyCommands();
+
+    // One of spawn or destroy is set
+    struct Command {
+      ObjectPtr spawn;
+      Object *destroy;
+    };
+    CommandBuffer< Command > commands;
+    LayerRegistry< Object > layers;
 };
 typedef std::shared_ptr< Scene > ScenePtr;
 
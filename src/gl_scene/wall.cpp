@@ -4,6 +4,7 @@
 
 #include "wall.h"
 #include "scene.h"
+#include "resource_cache.h"
 
 #include "object_frag.h"
 #include "object_vert.h"
@@ -19,15 +20,16 @@ Wall::Wall() {
 //    rotation.z = PI/2.0f;
 
     radius = 1.0f * scale.x;
+    layer = LAYER_WALL;
 
     // Initialize static resources if needed
-//    if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-//    if (!texture) texture = TexturePtr(new Texture{"wall.rgb", 512, 512});
-//    if (!mesh) mesh = MeshPtr(new Mesh{shader, "wall.obj"});
+//    if (!shader) shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+//    if (!texture) texture = ResourceCache::Get().GetTextureAsync("wall.rgb", 512, 512);
+//    if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("wall.obj");
 
-    if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-    if (!texture) texture = TexturePtr(new Texture{"white.rgb", 512, 512});
-    if (!mesh) mesh = MeshPtr(new Mesh{shader, "cube.obj"});
+    if (!shader) shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+    if (!texture) texture = ResourceCache::Get().GetTextureAsync("white.rgb", 512, 512);
+    if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("cube.obj");
 }
 
 Wall::~Wall() {
@@ -40,16 +42,8 @@ bool Wall::Update(Scene &scene, float dt) {
 }
 
 void Wall::Render(Scene &scene) {
-    shader->Use();
-
-    // use camera
-    shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-    shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
-    // render mesh
-    shader->SetMatrix(modelMatrix, "ModelMatrix");
-    shader->SetTexture(texture, "Texture");
-    mesh->Render();
+    // Drawn by the render queue together with all objects sharing mesh and texture
+    scene.renderQueue.Submit(mesh, shader, texture, modelMatrix);
 }
 
 // shared resources
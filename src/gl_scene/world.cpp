@@ -1,8 +1,9 @@
 #include "world.h"
 #include "scene.h"
+#include "resource_cache.h"
 
-#include "space_vert.h"
-#include "space_frag.h"
+#include "world_vert.h"
+#include "world_frag.h"
 
 World::World() {
   offset = 0;
@@ -10,9 +11,9 @@ World::World() {
   position.z = 1;
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{space_vert, space_frag});
-  if (!texture) texture = TexturePtr(new Texture{"backround.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "quad.obj"});
+  if (!shader) shader = ResourceCache::Get().GetShader(world_vert, world_frag);
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("backround.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("quad.obj");
 }
 
 World::~World() {
@@ -28,15 +29,8 @@ bool World::Update(Scene &scene, float dt) {
 
 void World::Render(Scene &scene) {
   // NOTE: this object does not use camera, just renders the entire quad as is
-  shader->Use();
-
-  // Pass UV mapping offset to the shader
-  shader->SetFloat(offset, "Offset");
-
-  // Render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
-  mesh->Render();
+  // UV mapping offset is passed to the shader as instance data
+  scene.renderQueue.Submit(mesh, shader, texture, modelMatrix, glm::vec4{offset, 0.0f, 0.0f, 0.0f});
 }
 
 // Static resources
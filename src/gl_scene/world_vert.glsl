@@ -3,16 +3,19 @@
 in vec3 Position;
 in vec2 TexCoord;
 
+// Per-instance inputs, the UV mapping offset is stored in the first component of InstanceData
+in mat4 InstanceModelMatrix;
+in vec4 InstanceData;
+
 // This will be passed to the fragment shader
 out vec2 FragTexCoord;
-
-// Matrices as program attributes
-uniform mat4 ModelMatrix;
+out float FragOffset;
 
 void main() {
   // Copy the input to the fragment shader
   FragTexCoord = TexCoord;
+  FragOffset = InstanceData.x;
 
   // Calculate the final position on screen
-  gl_Position = ModelMatrix * vec4(Position, 1.0);
+  gl_Position = InstanceModelMatrix * vec4(Position, 1.0);
 }
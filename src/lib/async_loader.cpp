@@ -0,0 +1,115 @@
+#include <chrono>
+#include <stdexcept>
+#include <iostream>
+
+#include "async_loader.h"
+
+AsyncLoader::AsyncLoader(unsigned int num_threads) : pending(0), stop(false) {
+  if (num_threads == 0) {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    num_threads = hardware_threads > 1 ? hardware_threads - 1 : 1;
+  }
+  for (unsigned int i = 0; i < num_threads; i++)
+    threads.emplace_back(&AsyncLoader::worker, this);
+}
+
+AsyncLoader::~AsyncLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  job_available.notify_all();
+  for (auto &thread : threads) thread.join();
+}
+
+void AsyncLoader::Enqueue(LoadFunction load) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(load));
+    pending++;
+  }
+  job_available.notify_one();
+}
+
+void AsyncLoader::worker() {
+  while (true) {
+    LoadFunction load;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_available.wait(lock, [this] { return stop || !jobs.empty(); });
+      if (stop) return;
+      load = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    // Exceptions must not escape the thread, a failed job simply has nothing to upload
+    UploadFunction upload;
+    try {
+      upload = load();
+    } catch (const std::exception &e) {
+      std::cerr << "Asynchronous load failed: " << e.what() << std::endl;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (upload)
+        uploads.push_back(std::move(upload));
+      else
+        pending--;
+    }
+    upload_available.notify_all();
+  }
+}
+
+AsyncLoader::FrameStats AsyncLoader::ProcessUploads(double budget_seconds) {
+  FrameStats stats = {0, 0, 0.0, 0};
+  auto start = std::chrono::steady_clock::now();
+
+  while (true) {
+    UploadFunction upload;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (uploads.empty()) break;
+      upload = std::move(uploads.front());
+      uploads.pop_front();
+    }
+
+    stats.bytes += upload();
+    stats.uploads++;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending--;
+    }
+
+    stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats.time >= budget_seconds) break;
+  }
+
+  stats.pending = GetPendingCount();
+  return stats;
+}
+
+AsyncLoader::FrameStats AsyncLoader::Finish() {
+  FrameStats total = {0, 0, 0.0, 0};
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      upload_available.wait(lock, [this] { return pending == 0 || !uploads.empty(); });
+      if (pending == 0) break;
+    }
+    auto stats = ProcessUploads(1.0);
+    total.uploads += stats.uploads;
+    total.bytes += stats.bytes;
+    total.time += stats.time;
+  }
+  return total;
+}
+
+size_t AsyncLoader::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending;
+}
+
+unsigned int AsyncLoader::GetThreadCount() const {
+  return (unsigned int) threads.size();
+}
@@ -0,0 +1,65 @@
+#ifndef PPGSO_ASYNC_LOADER_H
+#define PPGSO_ASYNC_LOADER_H
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+// Background loading of assets
+// Jobs run on a pool of worker threads and must not touch OpenGL, they read files and prepare CPU side data
+// Every job returns an upload step that is queued for the thread owning the OpenGL context
+// ProcessUploads runs the queued upload steps once per frame within a time budget so loading never stalls a frame
+class AsyncLoader {
+public:
+  // Runs on the OpenGL thread, returns the number of bytes sent to the GPU
+  typedef std::function<size_t()> UploadFunction;
+  // Runs on a worker thread, returns the upload step or an empty function if there is nothing to upload
+  typedef std::function<UploadFunction()> LoadFunction;
+
+  // Work done by one ProcessUploads call
+  struct FrameStats {
+    size_t uploads;   // upload steps executed
+    size_t bytes;     // bytes sent to the GPU
+    double time;      // seconds spent uploading
+    size_t pending;   // jobs still loading or waiting for upload
+  };
+
+  // Starts the worker threads, 0 uses all hardware threads but one that is left for rendering
+  AsyncLoader(unsigned int num_threads = 0);
+  // Stops the workers, queued jobs and uploads that did not run yet are dropped
+  ~AsyncLoader();
+
+  void Enqueue(LoadFunction load);
+
+  // Runs queued uploads until the budget in seconds is used up
+  // At least one upload runs per call so loading always progresses
+  FrameStats ProcessUploads(double budget_seconds);
+  // Blocks until all jobs are loaded and uploaded, use at startup or behind a loading screen
+  FrameStats Finish();
+
+  // Number of jobs still loading or waiting for upload
+  size_t GetPendingCount() const;
+  unsigned int GetThreadCount() const;
+
+private:
+  // Workers own threads, do not copy them
+  AsyncLoader(const AsyncLoader &) = delete;
+  AsyncLoader &operator=(const AsyncLoader &) = delete;
+
+  void worker();
+
+  std::vector<std::thread> threads;
+  std::deque<LoadFunction> jobs;
+  std::deque<UploadFunction> uploads;
+  size_t pending;
+  bool stop;
+  mutable std::mutex mutex;
+  std::condition_variable job_available;
+  std::condition_variable upload_available;
+};
+
+#endif // PPGSO_ASYNC_LOADER_H
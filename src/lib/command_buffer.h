@@ -0,0 +1,89 @@
+#ifndef PPGSO_COMMAND_BUFFER_H
+#define PPGSO_COMMAND_BUFFER_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <unordered_map>
+
+// Commands recorded while a pass runs and applied at a sync point after it
+// Every thread records into its own buffer, only the first Record of a thread takes a lock to create it
+// A thread caches the buffer of the last CommandBuffer it used, alternating between two of them takes the lock
+// Apply and Clear must not run concurrently with Record
+template<typename Command>
+class CommandBuffer {
+public:
+  CommandBuffer() : serial(nextSerial()) {
+  }
+
+  void Record(const Command &command) {
+    getBuffer().push_back(command);
+  }
+
+  // Calls function(command) for all recorded commands, buffer by buffer in the order the threads first recorded
+  // Commands recorded by the function are applied in the same call, returns the number of applied commands
+  template<typename Function>
+  size_t Apply(Function function) {
+    size_t applied = 0;
+    for (size_t b = 0; b < buffers.size(); b++) {
+      auto &buffer = *buffers[b];
+      for (size_t i = 0; i < buffer.size(); i++) {
+        // Copy first, the function may record into this buffer and move it
+        Command command = buffer[i];
+        function(command);
+        applied++;
+      }
+      buffer.clear();
+    }
+    return applied;
+  }
+
+  // Drops all recorded commands
+  void Clear() {
+    for (auto &buffer : buffers) buffer->clear();
+  }
+
+  size_t GetPendingCount() const {
+    size_t pending = 0;
+    for (auto &buffer : buffers) pending += buffer->size();
+    return pending;
+  }
+
+private:
+  CommandBuffer(const CommandBuffer &) = delete;
+  CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+  // Serial numbers identify instances in the thread cache, addresses could be reused by a new instance
+  static uint64_t nextSerial() {
+    static std::atomic<uint64_t> counter{1};
+    return counter++;
+  }
+
+  std::vector<Command> &getBuffer() {
+    struct Cache {
+      uint64_t serial;
+      std::vector<Command> *buffer;
+    };
+    static thread_local Cache cache = {0, nullptr};
+    if (cache.serial == serial) return *cache.buffer;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &buffer = threads[std::this_thread::get_id()];
+    if (!buffer) {
+      buffers.emplace_back(new std::vector<Command>());
+      buffer = buffers.back().get();
+    }
+    cache = {serial, buffer};
+    return *buffer;
+  }
+
+  uint64_t serial;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<std::vector<Command>>> buffers;
+  std::unordered_map<std::thread::id, std::vector<Command> *> threads;
+};
+
+#endif // PPGSO_COMMAND_BUFFER_H
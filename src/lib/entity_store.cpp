@@ -0,0 +1,129 @@
+#include <limits>
+
+#include "entity_store.h"
+#include "transform.h"
+
+uint32_t EntityStore::AddRenderable(const MeshPtr &mesh, const ShaderPtr &shader, const TexturePtr &texture) {
+  for (size_t i = 0; i < renderables.size(); i++) {
+    auto &renderable = renderables[i];
+    if (renderable.mesh == mesh && renderable.shader == shader && renderable.texture == texture) return (uint32_t) i;
+  }
+  renderables.push_back({mesh, shader, texture});
+  return (uint32_t) (renderables.size() - 1);
+}
+
+Entity EntityStore::Create() {
+  uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    slot = (uint32_t) indices.size();
+    indices.push_back(0);
+    generations.push_back(0);
+  }
+  indices[slot] = (uint32_t) slots.size();
+  slots.push_back(slot);
+
+  position.push_back(glm::vec3{0.0f});
+  rotation.push_back(glm::vec3{0.0f});
+  scale.push_back(glm::vec3{1.0f});
+  velocity.push_back(glm::vec3{0.0f});
+  angularMomentum.push_back(glm::vec3{0.0f});
+  age.push_back(0.0f);
+  lifetime.push_back(std::numeric_limits<float>::infinity());
+  modelMatrix.push_back(glm::mat4{1.0f});
+  dirty.push_back(1);
+  render.push_back(0);
+  return {slot, generations[slot]};
+}
+
+void EntityStore::Destroy(Entity entity) {
+  if (IsAlive(entity)) destroyIndex(indices[entity.slot]);
+}
+
+bool EntityStore::IsAlive(Entity entity) const {
+  return entity.slot < generations.size() && generations[entity.slot] == entity.generation;
+}
+
+size_t EntityStore::GetIndex(Entity entity) const {
+  return indices[entity.slot];
+}
+
+size_t EntityStore::Size() const {
+  return slots.size();
+}
+
+void EntityStore::Clear() {
+  for (auto slot : slots) {
+    generations[slot]++;
+    freeSlots.push_back(slot);
+  }
+  slots.clear();
+  position.clear();
+  rotation.clear();
+  scale.clear();
+  velocity.clear();
+  angularMomentum.clear();
+  age.clear();
+  lifetime.clear();
+  modelMatrix.clear();
+  dirty.clear();
+  render.clear();
+}
+
+void EntityStore::destroyIndex(size_t index) {
+  // The slot gets a new generation so old handles stop matching
+  uint32_t slot = slots[index];
+  generations[slot]++;
+  freeSlots.push_back(slot);
+
+  // Move the last entity into the gap
+  size_t last = slots.size() - 1;
+  if (index != last) {
+    slots[index] = slots[last];
+    indices[slots[index]] = (uint32_t) index;
+    position[index] = position[last];
+    rotation[index] = rotation[last];
+    scale[index] = scale[last];
+    velocity[index] = velocity[last];
+    angularMomentum[index] = angularMomentum[last];
+    age[index] = age[last];
+    lifetime[index] = lifetime[last];
+    modelMatrix[index] = modelMatrix[last];
+    dirty[index] = dirty[last];
+    render[index] = render[last];
+  }
+  slots.pop_back();
+  position.pop_back();
+  rotation.pop_back();
+  scale.pop_back();
+  velocity.pop_back();
+  angularMomentum.pop_back();
+  age.pop_back();
+  lifetime.pop_back();
+  modelMatrix.pop_back();
+  dirty.pop_back();
+  render.pop_back();
+}
+
+void EntityStore::Integrate(float dt) {
+  size_t count = Size();
+  for (size_t i = 0; i < count; i++) position[i] += velocity[i] * dt;
+  for (size_t i = 0; i < count; i++) rotation[i] += angularMomentum[i] * dt;
+  for (size_t i = 0; i < count; i++) age[i] += dt;
+  const glm::vec3 zero{0.0f};
+  for (size_t i = 0; i < count; i++) dirty[i] |= velocity[i] != zero || angularMomentum[i] != zero;
+}
+
+size_t EntityStore::UpdateModelMatrices() {
+  return ComposeTransforms(position.data(), rotation.data(), scale.data(), dirty.data(), modelMatrix.data(), Size());
+}
+
+void EntityStore::Submit(RenderQueue &queue) const {
+  if (renderables.empty()) return;
+  for (size_t i = 0; i < Size(); i++) {
+    auto &renderable = renderables[render[i]];
+    queue.Submit(renderable.mesh, renderable.shader, renderable.texture, modelMatrix[i]);
+  }
+}
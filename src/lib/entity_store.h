@@ -0,0 +1,98 @@
+#ifndef PPGSO_ENTITY_STORE_H
+#define PPGSO_ENTITY_STORE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+#include "render_queue.h"
+
+// Handle of an entity, stays valid until the entity is destroyed
+// The generation makes handles of destroyed entities invalid even when their slot is reused
+struct Entity {
+  uint32_t slot;
+  uint32_t generation;
+};
+
+// Storage of simple moving objects as structure of arrays
+// Each component is a separate array indexed by a dense index, systems walk the arrays linearly
+// Destroy moves the last entity into the gap, so dense indices change while handles stay valid
+// Model matrices are recomposed only for dirty entities, code writing position, rotation or scale sets dirty
+// Objects that need their own behavior stay Object subclasses, the scene runs both side by side
+class EntityStore {
+public:
+  // Shared rendering resources of entities, referenced from the render component
+  struct Renderable {
+    MeshPtr mesh;
+    ShaderPtr shader;
+    TexturePtr texture;
+  };
+
+  // Returns the index of the renderable, the same resources always get the same index
+  uint32_t AddRenderable(const MeshPtr &mesh, const ShaderPtr &shader, const TexturePtr &texture);
+
+  // New entity at the origin with unit scale, no motion, infinite lifetime and renderable 0
+  Entity Create();
+  void Destroy(Entity entity);
+  bool IsAlive(Entity entity) const;
+  // Dense index of a live entity into the component arrays
+  size_t GetIndex(Entity entity) const;
+  size_t Size() const;
+  // Destroys all entities, renderables are kept
+  void Clear();
+
+  // Systems
+  // Moves and rotates all entities and advances their age, moving entities become dirty
+  void Integrate(float dt);
+  // Destroys entities the predicate returns true for, it is called with the store and a dense index
+  template<typename Predicate>
+  size_t DestroyIf(Predicate predicate);
+  // Rebuilds model matrices of dirty entities from position, rotation and scale, see ComposeTransforms
+  // Returns the number of matrices rebuilt
+  size_t UpdateModelMatrices();
+  // Submits all entities to the render queue, nothing is drawn before the first AddRenderable
+  void Submit(RenderQueue &queue) const;
+
+  // Components, one element per entity
+  std::vector<glm::vec3> position;
+  std::vector<glm::vec3> rotation;
+  std::vector<glm::vec3> scale;
+  std::vector<glm::vec3> velocity;
+  std::vector<glm::vec3> angularMomentum;
+  std::vector<float> age;
+  std::vector<float> lifetime;
+  std::vector<glm::mat4> modelMatrix;
+  std::vector<uint8_t> dirty;
+  std::vector<uint32_t> render;
+
+private:
+  void destroyIndex(size_t index);
+
+  std::vector<Renderable> renderables;
+  // Entity slot of every dense index
+  std::vector<uint32_t> slots;
+  // Dense index and generation of every slot, freed slots are reused
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> generations;
+  std::vector<uint32_t> freeSlots;
+};
+
+template<typename Predicate>
+size_t EntityStore::DestroyIf(Predicate predicate) {
+  size_t destroyed = 0;
+  // Backwards, so the entity moved into a destroyed index has already been tested
+  for (size_t i = Size(); i-- > 0;) {
+    if (!predicate(*this, i)) continue;
+    destroyIndex(i);
+    destroyed++;
+  }
+  return destroyed;
+}
+
+#endif // PPGSO_ENTITY_STORE_H
@@ -0,0 +1,62 @@
+#include <cmath>
+
+#include "fixed_timestep.h"
+
+FixedTimestep::FixedTimestep(double step_rate, unsigned int max_steps) : step(1.0), max_steps(1) {
+  SetStepRate(step_rate);
+  SetMaxSteps(max_steps);
+  Reset();
+}
+
+void FixedTimestep::SetStepRate(double step_rate) {
+  if (step_rate > 0.0) step = 1.0 / step_rate;
+}
+
+double FixedTimestep::GetStepRate() const {
+  return 1.0 / step;
+}
+
+double FixedTimestep::GetStep() const {
+  return step;
+}
+
+void FixedTimestep::SetMaxSteps(unsigned int max_steps) {
+  this->max_steps = max_steps > 0 ? max_steps : 1;
+}
+
+unsigned int FixedTimestep::Advance(double frame_time) {
+  // Clocks are not guaranteed to be monotonic across suspends
+  if (frame_time > 0.0) accumulator += frame_time;
+
+  unsigned int steps = 0;
+  while (accumulator >= step && steps < max_steps) {
+    accumulator -= step;
+    steps++;
+  }
+
+  // Keep less than one step so the next frame does not start behind
+  if (accumulator >= step) {
+    double kept = std::fmod(accumulator, step);
+    stats.dropped_time += accumulator - kept;
+    accumulator = kept;
+    stats.capped_frames++;
+  }
+
+  stats.steps = steps;
+  stats.frames++;
+  stats.total_steps += steps;
+  return steps;
+}
+
+float FixedTimestep::GetAlpha() const {
+  return (float) (accumulator / step);
+}
+
+void FixedTimestep::Reset() {
+  accumulator = 0.0;
+  stats = {0, 0, 0, 0, 0.0};
+}
+
+const FixedTimestep::Stats &FixedTimestep::GetStats() const {
+  return stats;
+}
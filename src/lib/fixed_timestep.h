@@ -0,0 +1,46 @@
+#ifndef PPGSO_FIXED_TIMESTEP_H
+#define PPGSO_FIXED_TIMESTEP_H
+
+#include <cstdint>
+
+// Clock of a simulation running in steps of constant length, independent of the frame rate
+// Frame times are accumulated and consumed in whole steps, the remainder is carried to the next frame
+// At most a limited number of steps runs per frame, under load the time beyond them is dropped
+// so the simulation slows down instead of falling further behind with every frame
+class FixedTimestep {
+public:
+  // Steps of the last frame and totals since the clock was created or reset
+  struct Stats {
+    unsigned int steps;         // steps to run for the last frame
+    uint64_t frames;            // frames passed to Advance
+    uint64_t total_steps;       // steps of all frames
+    uint64_t capped_frames;     // frames that hit the step limit
+    double dropped_time;        // seconds dropped by the step limit
+  };
+
+  explicit FixedTimestep(double step_rate = 60.0, unsigned int max_steps = 5);
+
+  // Steps per second, the accumulated time is kept
+  void SetStepRate(double step_rate);
+  double GetStepRate() const;
+  // Length of one step in seconds
+  double GetStep() const;
+  void SetMaxSteps(unsigned int max_steps);
+
+  // Adds the time of a frame in seconds and returns the number of steps to simulate for it
+  unsigned int Advance(double frame_time);
+  // Fraction of a step accumulated after the last step, renderers blend the last two steps by it
+  float GetAlpha() const;
+
+  // Forgets the accumulated time and the statistics
+  void Reset();
+  const Stats &GetStats() const;
+
+private:
+  double step;
+  unsigned int max_steps;
+  double accumulator;
+  Stats stats;
+};
+
+#endif // PPGSO_FIXED_TIMESTEP_H
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+#include "frustum.h"
+
+Bounds ComputeBounds(const uint8_t *vertices, size_t count, size_t stride, size_t offset) {
+  Bounds bounds;
+  bounds.min = bounds.max = bounds.center = glm::vec3{0.0f};
+  bounds.radius = 0.0f;
+  if (count == 0) return bounds;
+
+  float position[3];
+  memcpy(position, vertices + offset, sizeof(position));
+  bounds.min = bounds.max = glm::vec3{position[0], position[1], position[2]};
+  for (size_t i = 1; i < count; i++) {
+    memcpy(position, vertices + i * stride + offset, sizeof(position));
+    glm::vec3 point{position[0], position[1], position[2]};
+    bounds.min = glm::min(bounds.min, point);
+    bounds.max = glm::max(bounds.max, point);
+  }
+
+  // Second pass for the farthest vertex from the box center
+  bounds.center = (bounds.min + bounds.max) * 0.5f;
+  float radius2 = 0.0f;
+  for (size_t i = 0; i < count; i++) {
+    memcpy(position, vertices + i * stride + offset, sizeof(position));
+    glm::vec3 delta = glm::vec3{position[0], position[1], position[2]} - bounds.center;
+    radius2 = std::max(radius2, glm::dot(delta, delta));
+  }
+  bounds.radius = std::sqrt(radius2);
+  return bounds;
+}
+
+void SphereList::Clear() {
+  x.clear();
+  y.clear();
+  z.clear();
+  radius.clear();
+}
+
+void SphereList::Add(const glm::vec3 &center, float radius) {
+  x.push_back(center.x);
+  y.push_back(center.y);
+  z.push_back(center.z);
+  this->radius.push_back(radius);
+}
+
+size_t SphereList::Size() const {
+  return x.size();
+}
+
+Frustum::Frustum() {
+  // Planes at infinity, every point is inside
+  for (auto &plane : planes) plane = glm::vec4{0.0f, 0.0f, 0.0f, INFINITY};
+}
+
+void Frustum::Update(const glm::mat4 &viewProjection) {
+  // Gribb-Hartmann, GLM matrices are column major so row i is m[0][i], m[1][i], m[2][i], m[3][i]
+  const glm::mat4 &m = viewProjection;
+  glm::vec4 row[4];
+  for (int i = 0; i < 4; i++) row[i] = glm::vec4{m[0][i], m[1][i], m[2][i], m[3][i]};
+
+  planes[PLANE_LEFT] = row[3] + row[0];
+  planes[PLANE_RIGHT] = row[3] - row[0];
+  planes[PLANE_BOTTOM] = row[3] + row[1];
+  planes[PLANE_TOP] = row[3] - row[1];
+  planes[PLANE_NEAR] = row[3] + row[2];
+  planes[PLANE_FAR] = row[3] - row[2];
+
+  for (auto &plane : planes) plane /= glm::length(glm::vec3(plane));
+}
+
+const glm::vec4 &Frustum::GetPlane(Plane plane) const {
+  return planes[plane];
+}
+
+bool Frustum::IsVisible(const glm::vec3 &center, float radius) const {
+  for (auto &plane : planes)
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+  return true;
+}
+
+size_t Frustum::Cull(const SphereList &spheres, uint8_t *visible) const {
+  const float *x = spheres.x.data(), *y = spheres.y.data(), *z = spheres.z.data(), *r = spheres.radius.data();
+  size_t count = spheres.Size();
+  size_t blocks = count - count % CULL_BLOCK;
+  size_t result = 0;
+
+  // Fixed size inner loops without branches, the compiler keeps a block in vector registers for all planes
+  for (size_t i = 0; i < blocks; i += CULL_BLOCK) {
+    int inside[CULL_BLOCK];
+    for (size_t lane = 0; lane < CULL_BLOCK; lane++) inside[lane] = 1;
+    for (auto &plane : planes) {
+      for (size_t lane = 0; lane < CULL_BLOCK; lane++) {
+        float distance = plane.x * x[i + lane] + plane.y * y[i + lane] + plane.z * z[i + lane] + plane.w;
+        inside[lane] &= distance >= -r[i + lane];
+      }
+    }
+    for (size_t lane = 0; lane < CULL_BLOCK; lane++) {
+      visible[i + lane] = (uint8_t) inside[lane];
+      result += inside[lane];
+    }
+  }
+
+  for (size_t i = blocks; i < count; i++) {
+    visible[i] = (uint8_t) IsVisible(glm::vec3{x[i], y[i], z[i]}, r[i]);
+    result += visible[i];
+  }
+  return result;
+}
@@ -0,0 +1,65 @@
+#ifndef PPGSO_FRUSTUM_H
+#define PPGSO_FRUSTUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+// Bounding volumes of a mesh in model space, computed from the vertex positions at load
+struct Bounds {
+  glm::vec3 min;
+  glm::vec3 max;
+  // Sphere around the box center enclosing all vertices, tighter than the sphere around the box
+  glm::vec3 center;
+  float radius;
+};
+
+// Bounds of the positions of interleaved vertices, position is 3 floats at offset in each stride bytes
+Bounds ComputeBounds(const uint8_t *vertices, size_t count, size_t stride, size_t offset);
+
+// Bounding spheres in structure of arrays layout, so the cull loop reads each component with unit stride
+struct SphereList {
+  std::vector<float> x, y, z, radius;
+
+  void Clear();
+  void Add(const glm::vec3 &center, float radius);
+  size_t Size() const;
+};
+
+// View frustum as six planes extracted from a view projection matrix
+// Plane normals point inside and are normalized, so plane distances of points are in world units
+class Frustum {
+public:
+  enum Plane {
+    PLANE_LEFT = 0,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR,
+    PLANE_COUNT
+  };
+
+  // Spheres culled together by Cull, the inner loops over them vectorize to SSE or AVX
+  static const size_t CULL_BLOCK = 8;
+
+  // Everything is visible until the first Update
+  Frustum();
+
+  // Extracts the planes from the rows of projection * view
+  void Update(const glm::mat4 &viewProjection);
+  const glm::vec4 &GetPlane(Plane plane) const;
+
+  bool IsVisible(const glm::vec3 &center, float radius) const;
+  // Writes 1 for spheres intersecting the frustum and 0 for the others, returns the number of visible spheres
+  size_t Cull(const SphereList &spheres, uint8_t *visible) const;
+
+private:
+  glm::vec4 planes[PLANE_COUNT];
+};
+
+#endif // PPGSO_FRUSTUM_H
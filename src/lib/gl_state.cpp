@@ -0,0 +1,131 @@
+#include "gl_state.h"
+
+GLState &GLState::Get() {
+  static GLState state;
+  return state;
+}
+
+GLState::GLState() : current{0, 0, 0}, frame{0, 0, 0}, total{0, 0, 0}, frames(0) {
+  Invalidate();
+}
+
+template<typename T>
+bool GLState::change(T &cached, T value) {
+  if (cached == value) {
+    current.skipped++;
+    return false;
+  }
+  cached = value;
+  current.issued++;
+  return true;
+}
+
+void GLState::UseProgram(GLuint program) {
+  if (change(this->program, program)) glUseProgram(program);
+}
+
+void GLState::BindTexture(GLuint texture, GLuint unit) {
+  if (unit >= TEXTURE_UNITS) {
+    if (change(active_unit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+    current.issued++;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    return;
+  }
+  // Texture edits such as glTexParameteri act on the active unit, so it is switched even when the texture
+  // is already bound there, only the bind counts as skipped then
+  if (active_unit != unit) {
+    active_unit = unit;
+    current.issued++;
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+  if (change(textures[unit], texture)) glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLState::BindVertexArray(GLuint vao) {
+  if (change(this->vao, vao)) glBindVertexArray(vao);
+}
+
+void GLState::setCapability(GLenum capability, int &cached, bool enabled) {
+  if (!change(cached, enabled ? 1 : 0)) return;
+  if (enabled)
+    glEnable(capability);
+  else
+    glDisable(capability);
+}
+
+void GLState::SetBlend(bool enabled) {
+  setCapability(GL_BLEND, blend, enabled);
+}
+
+void GLState::SetBlendFunc(GLenum source, GLenum destination) {
+  if (blend_source == source && blend_destination == destination) {
+    current.skipped++;
+    return;
+  }
+  blend_source = source;
+  blend_destination = destination;
+  current.issued++;
+  glBlendFunc(source, destination);
+}
+
+void GLState::SetDepthTest(bool enabled) {
+  setCapability(GL_DEPTH_TEST, depth_test, enabled);
+}
+
+void GLState::SetDepthMask(bool enabled) {
+  if (change(depth_mask, enabled ? 1 : 0)) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::SetCullFace(bool enabled) {
+  setCapability(GL_CULL_FACE, cull_face, enabled);
+}
+
+void GLState::CountDraw() {
+  current.draws++;
+}
+
+void GLState::Invalidate() {
+  program = vao = active_unit = UNKNOWN;
+  for (auto &texture : textures) texture = UNKNOWN;
+  blend_source = blend_destination = UNKNOWN;
+  blend = depth_test = depth_mask = cull_face = -1;
+}
+
+void GLState::ForgetProgram(GLuint program) {
+  if (this->program == program) this->program = UNKNOWN;
+}
+
+void GLState::ForgetTexture(GLuint texture) {
+  for (auto &bound : textures)
+    if (bound == texture) bound = UNKNOWN;
+}
+
+void GLState::ForgetVertexArray(GLuint vao) {
+  if (this->vao == vao) this->vao = UNKNOWN;
+}
+
+GLState::Stats GLState::EndFrame() {
+  frame = current;
+  total.issued += current.issued;
+  total.skipped += current.skipped;
+  total.draws += current.draws;
+  current = {0, 0, 0};
+  frames++;
+  return frame;
+}
+
+const GLState::Stats &GLState::GetCurrentStats() const {
+  return current;
+}
+
+const GLState::Stats &GLState::GetFrameStats() const {
+  return frame;
+}
+
+const GLState::Stats &GLState::GetTotalStats() const {
+  return total;
+}
+
+size_t GLState::GetFrameCount() const {
+  return frames;
+}
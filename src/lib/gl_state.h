@@ -0,0 +1,80 @@
+#ifndef PPGSO_GL_STATE_H
+#define PPGSO_GL_STATE_H
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+// Shadow copy of the OpenGL state changed between draw calls
+// Each setter compares with the last value it issued and skips the GL call when nothing changes
+// Shader, Texture and Mesh bind through it, code that changes the same state with raw GL calls must call Invalidate
+class GLState {
+public:
+  // Number of state changes sent to OpenGL, number of redundant ones filtered out and number of draw calls
+  struct Stats {
+    size_t issued;
+    size_t skipped;
+    size_t draws;
+  };
+
+  // Texture units tracked by the cache, binds to higher units are always issued
+  static const unsigned int TEXTURE_UNITS = 32;
+
+  // State of the OpenGL context current on the rendering thread
+  static GLState &Get();
+
+  void UseProgram(GLuint program);
+  // Binds a 2D texture to a texture unit and leaves that unit active, so the texture can be edited afterwards
+  void BindTexture(GLuint texture, GLuint unit = 0);
+  void BindVertexArray(GLuint vao);
+
+  void SetBlend(bool enabled);
+  void SetBlendFunc(GLenum source, GLenum destination);
+  void SetDepthTest(bool enabled);
+  void SetDepthMask(bool enabled);
+  void SetCullFace(bool enabled);
+
+  // Counts a draw call in the frame statistics
+  void CountDraw();
+
+  // Forgets all cached values, the next call of every setter is issued
+  void Invalidate();
+  // Deleted names may be reused by OpenGL for new objects, forget them so the new object gets bound
+  void ForgetProgram(GLuint program);
+  void ForgetTexture(GLuint texture);
+  void ForgetVertexArray(GLuint vao);
+
+  // Closes the statistics of the current frame and returns them
+  Stats EndFrame();
+  // Statistics of the frame in progress, of the last finished frame and of all frames together
+  const Stats &GetCurrentStats() const;
+  const Stats &GetFrameStats() const;
+  const Stats &GetTotalStats() const;
+  size_t GetFrameCount() const;
+
+private:
+  GLState();
+
+  // Returns true when the value differs from the cached one and has to be issued
+  template<typename T>
+  bool change(T &cached, T value);
+  void setCapability(GLenum capability, int &cached, bool enabled);
+
+  // Unknown values never match, so the first call after Invalidate is always issued
+  static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+  GLuint program;
+  GLuint vao;
+  GLuint active_unit;
+  GLuint textures[TEXTURE_UNITS];
+  GLenum blend_source, blend_destination;
+  // -1 unknown, 0 disabled, 1 enabled
+  int blend, depth_test, depth_mask, cull_face;
+
+  Stats current;
+  Stats frame;
+  Stats total;
+  size_t frames;
+};
+
+#endif // PPGSO_GL_STATE_H
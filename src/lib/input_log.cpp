@@ -0,0 +1,186 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <cstring>
+
+#include "input_log.h"
+
+// File identification and format version
+static const char MAGIC[4] = {'P', 'P', 'I', 'L'};
+static const uint32_t VERSION = 1;
+
+// Little endian fixed size and variable length integers, independent of the host byte order
+static void WriteFixed(std::string &out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+static void WriteVarint(std::string &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back((char) ((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back((char) value);
+}
+
+// Keeps small negative key codes such as GLFW_KEY_UNKNOWN short
+static uint64_t ZigZag(int32_t value) {
+  return ((uint64_t) (uint32_t) value << 1) ^ (uint64_t) (int64_t) (value >> 31);
+}
+
+static int32_t UnZigZag(uint64_t value) {
+  return (int32_t) ((uint32_t) (value >> 1) ^ (uint32_t) -(int64_t) (value & 1));
+}
+
+static uint32_t FloatBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static float BitsFloat(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Sequential reader of a loaded file, reads past the end fail and leave ok false
+struct Reader {
+  const std::string &data;
+  size_t offset;
+  bool ok;
+
+  uint64_t Fixed(int bytes) {
+    uint64_t value = 0;
+    if (offset + bytes > data.size()) {
+      ok = false;
+      return 0;
+    }
+    for (int i = 0; i < bytes; i++) value |= (uint64_t) (uint8_t) data[offset++] << (8 * i);
+    return value;
+  }
+
+  uint64_t Varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (offset >= data.size()) break;
+      auto byte = (uint8_t) data[offset++];
+      value |= (uint64_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    ok = false;
+    return 0;
+  }
+};
+
+InputLog::InputLog() : seed(0), stepRate(60.0), stepCount(0), cursor(0) {
+}
+
+void InputLog::RecordKey(uint32_t step, int key, int action) {
+  events.push_back({step, EVENT_KEY, key, action, 0.0f, 0.0f});
+}
+
+void InputLog::RecordMouseMove(uint32_t step, double x, double y) {
+  events.push_back({step, EVENT_MOUSE_MOVE, 0, 0, (float) x, (float) y});
+}
+
+void InputLog::Clear() {
+  events.clear();
+  stepCount = 0;
+  cursor = 0;
+}
+
+const std::vector<InputLog::Event> &InputLog::GetEvents() const {
+  return events;
+}
+
+void InputLog::Rewind() {
+  cursor = 0;
+}
+
+bool InputLog::Save(const std::string &file) const {
+  std::string out(MAGIC, sizeof(MAGIC));
+  WriteFixed(out, VERSION, 4);
+  WriteFixed(out, seed, 8);
+  uint64_t rateBits;
+  memcpy(&rateBits, &stepRate, sizeof(rateBits));
+  WriteFixed(out, rateBits, 8);
+  WriteFixed(out, stepCount, 4);
+  WriteVarint(out, events.size());
+
+  uint32_t step = 0;
+  for (auto &event : events) {
+    WriteVarint(out, event.step - step);
+    step = event.step;
+    out.push_back((char) event.type);
+    if (event.type == EVENT_KEY) {
+      WriteVarint(out, ZigZag(event.key));
+      WriteVarint(out, ZigZag(event.action));
+    } else {
+      WriteFixed(out, FloatBits(event.x), 4);
+      WriteFixed(out, FloatBits(event.y), 4);
+    }
+  }
+
+  std::ofstream stream(file, std::ios::binary);
+  if (!stream.write(out.data(), out.size())) {
+    std::cerr << "Could not write input log " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool InputLog::Load(const std::string &file) {
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream.is_open()) {
+    std::cerr << "Could not open input log " << file << std::endl;
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+  Reader reader{data, 0, true};
+  if (data.size() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    std::cerr << file << " is not an input log" << std::endl;
+    return false;
+  }
+  reader.offset = sizeof(MAGIC);
+  auto version = (uint32_t) reader.Fixed(4);
+  if (version != VERSION) {
+    std::cerr << "Input log " << file << " has unsupported version " << version << std::endl;
+    return false;
+  }
+
+  std::vector<Event> loaded;
+  auto loadedSeed = reader.Fixed(8);
+  auto rateBits = reader.Fixed(8);
+  auto loadedSteps = (uint32_t) reader.Fixed(4);
+  auto count = reader.Varint();
+  uint32_t step = 0;
+  for (uint64_t i = 0; i < count && reader.ok; i++) {
+    Event event = {0, EVENT_KEY, 0, 0, 0.0f, 0.0f};
+    step += (uint32_t) reader.Varint();
+    event.step = step;
+    auto type = reader.Fixed(1);
+    if (type == EVENT_KEY) {
+      event.key = UnZigZag(reader.Varint());
+      event.action = UnZigZag(reader.Varint());
+    } else if (type == EVENT_MOUSE_MOVE) {
+      event.type = EVENT_MOUSE_MOVE;
+      event.x = BitsFloat((uint32_t) reader.Fixed(4));
+      event.y = BitsFloat((uint32_t) reader.Fixed(4));
+    } else {
+      reader.ok = false;
+    }
+    loaded.push_back(event);
+  }
+  if (!reader.ok) {
+    std::cerr << "Input log " << file << " is damaged" << std::endl;
+    return false;
+  }
+
+  seed = loadedSeed;
+  memcpy(&stepRate, &rateBits, sizeof(stepRate));
+  stepCount = loadedSteps;
+  events.swap(loaded);
+  cursor = 0;
+  return true;
+}
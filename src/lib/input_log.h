@@ -0,0 +1,66 @@
+#ifndef PPGSO_INPUT_LOG_H
+#define PPGSO_INPUT_LOG_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Keyboard and mouse events of a session stamped with the simulation step they were applied before
+// Together with the random seed and the step rate a replay runs exactly the same simulation as the recording
+// Files store the steps as deltas in variable length integers, a key event takes about 4 bytes
+class InputLog {
+public:
+  enum EventType : uint8_t {
+    EVENT_KEY = 0,
+    EVENT_MOUSE_MOVE = 1
+  };
+
+  struct Event {
+    uint32_t step;
+    EventType type;
+    // Key events
+    int32_t key;
+    int32_t action;
+    // Mouse events
+    float x, y;
+  };
+
+  InputLog();
+
+  // Events must be recorded in the order of their steps
+  void RecordKey(uint32_t step, int key, int action);
+  void RecordMouseMove(uint32_t step, double x, double y);
+  void Clear();
+
+  // Session parameters stored with the events
+  uint64_t seed;
+  double stepRate;
+  // Steps simulated by the recorded session
+  uint32_t stepCount;
+
+  const std::vector<Event> &GetEvents() const;
+
+  // Writes and reads the binary log, errors are reported to std::cerr
+  bool Save(const std::string &file) const;
+  bool Load(const std::string &file);
+
+  // Calls function(event) for the events of the step, steps must be replayed in increasing order
+  template<typename Function>
+  size_t Replay(uint32_t step, Function function) {
+    size_t replayed = 0;
+    while (cursor < events.size() && events[cursor].step <= step) {
+      function(events[cursor++]);
+      replayed++;
+    }
+    return replayed;
+  }
+  // Starts the replay from the first event again
+  void Rewind();
+
+private:
+  std::vector<Event> events;
+  size_t cursor;
+};
+
+#endif // PPGSO_INPUT_LOG_H
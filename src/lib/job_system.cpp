@@ -0,0 +1,105 @@
+#include <algorithm>
+
+#include "job_system.h"
+
+JobSystem::JobSystem(unsigned int num_threads) : remaining(0), generation(0), stopping(false) {
+  start(num_threads);
+}
+
+JobSystem::~JobSystem() {
+  stop();
+}
+
+void JobSystem::SetThreadCount(unsigned int num_threads) {
+  stop();
+  start(num_threads);
+}
+
+unsigned int JobSystem::GetThreadCount() const {
+  return (unsigned int) queues.size();
+}
+
+void JobSystem::start(unsigned int num_threads) {
+  if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+  stopping = false;
+
+  // Queue 0 belongs to the thread calling ParallelFor
+  for (unsigned int i = 0; i < num_threads; i++) queues.emplace_back(new Queue());
+  for (unsigned int i = 1; i < num_threads; i++) threads.emplace_back(&JobSystem::worker, this, i);
+}
+
+void JobSystem::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  job_available.notify_all();
+  for (auto &thread : threads) thread.join();
+  threads.clear();
+  queues.clear();
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const RangeFunction &function) {
+  if (count == 0) return;
+  if (grain == 0) grain = 1;
+  size_t num_jobs = (count + grain - 1) / grain;
+  size_t num_queues = queues.size();
+  if (num_queues == 1 || num_jobs == 1) {
+    function(0, count);
+    return;
+  }
+
+  remaining = num_jobs;
+  for (size_t q = 0; q < num_queues; q++) {
+    auto &queue = *queues[q];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (size_t j = num_jobs * q / num_queues; j < num_jobs * (q + 1) / num_queues; j++)
+      queue.jobs.push_back({&function, j * grain, std::min(count, (j + 1) * grain)});
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation++;
+  }
+  job_available.notify_all();
+
+  // Work until every job finished, the last ones may still run on other threads when the queues are empty
+  while (remaining.load(std::memory_order_acquire) > 0)
+    if (!runJob(0)) std::this_thread::yield();
+}
+
+bool JobSystem::runJob(unsigned int index) {
+  Job job;
+  bool found = false;
+  size_t num_queues = queues.size();
+  for (size_t i = 0; i < num_queues && !found; i++) {
+    auto &queue = *queues[(index + i) % num_queues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) continue;
+    if (i == 0) {
+      job = queue.jobs.front();
+      queue.jobs.pop_front();
+    } else {
+      job = queue.jobs.back();
+      queue.jobs.pop_back();
+    }
+    found = true;
+  }
+  if (!found) return false;
+
+  (*job.function)(job.begin, job.end);
+  remaining.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void JobSystem::worker(unsigned int index) {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_available.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+    }
+    while (runJob(index)) {}
+  }
+}
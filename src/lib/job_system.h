@@ -0,0 +1,67 @@
+#ifndef PPGSO_JOB_SYSTEM_H
+#define PPGSO_JOB_SYSTEM_H
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Work stealing pool for data parallel loops of the frame update
+// Every thread owns a queue of jobs, it takes them from the front and threads with an empty queue steal from the back
+// The thread calling ParallelFor works on the jobs too, so one thread runs everything on the caller
+class JobSystem {
+public:
+  // Runs on a range [begin, end) of the items
+  typedef std::function<void(size_t, size_t)> RangeFunction;
+
+  // Number of threads including the caller, 0 uses all hardware threads
+  explicit JobSystem(unsigned int num_threads = 0);
+  // Stops the workers, must not be called during ParallelFor
+  ~JobSystem();
+
+  // Restarts the workers with a new number of threads, must not be called during ParallelFor
+  void SetThreadCount(unsigned int num_threads);
+  unsigned int GetThreadCount() const;
+
+  // Splits [0, count) into ranges of grain items and returns when function ran on all of them
+  // The ranges are dealt out to the thread queues in contiguous blocks, so each thread starts on neighbouring items
+  // Calls from more than one thread at a time are not supported
+  void ParallelFor(size_t count, size_t grain, const RangeFunction &function);
+
+private:
+  // Workers own threads, do not copy them
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  struct Job {
+    const RangeFunction *function;
+    size_t begin, end;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void start(unsigned int num_threads);
+  void stop();
+  void worker(unsigned int index);
+  // Runs one job from the own queue or stolen from another one, false when all queues are empty
+  bool runJob(unsigned int index);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+  std::atomic<size_t> remaining;
+  uint64_t generation;
+  bool stopping;
+  std::mutex mutex;
+  std::condition_variable job_available;
+};
+
+#endif // PPGSO_JOB_SYSTEM_H
@@ -0,0 +1,49 @@
+#ifndef PPGSO_LAYER_REGISTRY_H
+#define PPGSO_LAYER_REGISTRY_H
+
+#include <vector>
+#include <cstddef>
+
+// Contiguous lists of objects grouped by layer, so code can visit all objects of one kind without casts
+// Add appends and Remove swaps the last object into the gap, both in constant time, order is not kept
+// T provides the members used for the bookkeeping:
+//   layer       - layer number below the count passed to the constructor, read on Add and Remove
+//   layerIndex  - position in its list, written by the registry
+template<typename T>
+class LayerRegistry {
+public:
+  explicit LayerRegistry(unsigned int layers) : lists(layers) {
+  }
+
+  void Add(T *object) {
+    auto &list = lists[object->layer];
+    object->layerIndex = list.size();
+    list.push_back(object);
+  }
+
+  // The object has to be in the registry
+  void Remove(T *object) {
+    auto &list = lists[object->layer];
+    auto last = list.back();
+    last->layerIndex = object->layerIndex;
+    list[object->layerIndex] = last;
+    list.pop_back();
+  }
+
+  void Clear() {
+    for (auto &list : lists) list.clear();
+  }
+
+  const std::vector<T *> &Get(unsigned int layer) const {
+    return lists[layer];
+  }
+
+  unsigned int GetLayerCount() const {
+    return (unsigned int) lists.size();
+  }
+
+private:
+  std::vector<std::vector<T *>> lists;
+};
+
+#endif // PPGSO_LAYER_REGISTRY_H
@@ -0,0 +1,103 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filename) : open(false), data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {
+  file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) return;
+  size = (size_t) file_size.QuadPart;
+  open = true;
+
+  // Zero length files can not be mapped
+  if (size == 0) return;
+
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    open = false;
+    return;
+  }
+  data = (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data) open = false;
+}
+
+MappedFile::~MappedFile() {
+  if (data) UnmapViewOfFile(data);
+  if (mapping) CloseHandle(mapping);
+  if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &filename) : open(false), data(nullptr), size(0), file(-1) {
+  file = ::open(filename.c_str(), O_RDONLY);
+  if (file < 0) return;
+
+  struct stat info;
+  if (fstat(file, &info) != 0) return;
+  size = (size_t) info.st_size;
+  open = true;
+
+  // Zero length files can not be mapped
+  if (size == 0) return;
+
+  void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (address == MAP_FAILED) {
+    open = false;
+    return;
+  }
+  data = (const char *) address;
+
+  // Files are usually parsed front to back
+  madvise(address, size, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() {
+  if (data) munmap((void *) data, size);
+  if (file >= 0) close(file);
+}
+
+#endif
+
+bool MappedFile::IsOpen() const {
+  return open;
+}
+
+const char *MappedFile::Data() const {
+  return data;
+}
+
+size_t MappedFile::Size() const {
+  return size;
+}
+
+long long MappedFile::GetModificationTime(const std::string &filename) {
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) return 0;
+#if defined(_WIN32)
+  return (long long) info.st_mtime * 1000000000LL;
+#elif defined(__APPLE__)
+  return (long long) info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+  return (long long) info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+}
+
+long long MappedFile::GetFileSize(const std::string &filename) {
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) return 0;
+  return (long long) info.st_size;
+}
@@ -0,0 +1,41 @@
+#ifndef PPGSO_MAPPED_FILE_H
+#define PPGSO_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+// The mapping is released when the object is destroyed
+// On failure IsOpen returns false and Data returns nullptr, empty files map to a null range
+class MappedFile {
+public:
+  MappedFile(const std::string &filename);
+  ~MappedFile();
+
+  bool IsOpen() const;
+  const char *Data() const;
+  size_t Size() const;
+
+  // Modification time of a file in nanoseconds, 0 if the file does not exist
+  // File systems and platforms without sub second times give whole seconds
+  static long long GetModificationTime(const std::string &filename);
+  // Size of a file in bytes, 0 if the file does not exist
+  static long long GetFileSize(const std::string &filename);
+
+private:
+  // Mappings own OS handles, do not copy them
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open;
+  const char *data;
+  size_t size;
+#ifdef _WIN32
+  void *file;
+  void *mapping;
+#else
+  int file;
+#endif
+};
+
+#endif // PPGSO_MAPPED_FILE_H
@@ -1,122 +1,235 @@
+#include <cstddef>
+#include <algorithm>
+
 #include "mesh.h"
 #include "tiny_obj_loader.h"
+#include "obj_cache.h"
+#include "gl_state.h"
+
+Mesh::Mesh() {
+  this->vao = this->vbo = this->ibo = this->instance_vbo = 0;
+  this->instance_capacity = 0;
+  this->index_type = GL_UNSIGNED_INT;
+  this->index_size = sizeof(GLuint);
+  this->mesh_indices_count = 0;
+  this->cache_stats = VertexCacheStats();
+  this->memory_size = 0;
+  this->bounds = ComputeBounds(nullptr, 0, 0, 0);
+  static unsigned int next_id = 0;
+  this->id = next_id++;
+}
+
+Mesh::~Mesh() {
+  // Placeholders never created any OpenGL objects
+  if (!this->vao) return;
+  // Names of deleted objects are reused, the state cache must not skip a bind of the next one
+  GLState::Get().ForgetVertexArray(this->vao);
+  glDeleteVertexArrays(1, &this->vao);
+  glDeleteBuffers(1, &this->vbo);
+  glDeleteBuffers(1, &this->ibo);
+  glDeleteBuffers(1, &this->instance_vbo);
+}
 
-Mesh::Mesh(ShaderPtr program, const std::string &obj_file) {
+Mesh::Mesh(const std::string &obj_file, VertexFormat format, unsigned int optimize) : Mesh() {
+  MeshData data;
+  if (Load(obj_file, format, optimize, data))
+    Upload(data);
+}
+
+Mesh::Mesh(ShaderPtr program, const std::string &obj_file, VertexFormat format, unsigned int optimize)
+    : Mesh(obj_file, format, optimize) {
   this->program = program;
-  this->initGeometry(obj_file);
 }
 
-Mesh::Mesh(ShaderPtr program, const std::string &obj_file, const TexturePtr texture) {
-  Mesh(program, obj_file);
+Mesh::Mesh(ShaderPtr program, const std::string &obj_file, const TexturePtr texture) : Mesh(program, obj_file) {
   this->texture = texture;
 }
 
-void Mesh::initGeometry(const std::string &obj_file) {
-  // Load OBJ file
+// Material files are looked up next to the OBJ file
+static std::string GetDirectory(const std::string &file) {
+  auto separator = file.find_last_of("/\\");
+  if (separator == std::string::npos) return "";
+  return file.substr(0, separator + 1);
+}
+
+// Points an attribute location to the interleaved vertex buffer
+static void SetAttribPointer(ShaderAttribute attrib, GLint size, GLenum type, GLboolean normalized,
+                             const PackedMesh &packed, size_t offset) {
+  glEnableVertexAttribArray(attrib);
+  glVertexAttribPointer(attrib, size, type, normalized, (GLsizei) packed.layout.stride, (const GLvoid *) offset);
+}
+
+bool Mesh::Load(const std::string &obj_file, VertexFormat format, unsigned int optimize, MeshData &data) {
+  // Load OBJ file, parsed data is reused from the binary cache when possible
   std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
-  std::string err = tinyobj::LoadObj(shapes, materials, obj_file.c_str());
+  std::string mtl_basepath = GetDirectory(obj_file);
+  std::string err = LoadObjCached(shapes, data.materials, obj_file, mtl_basepath.c_str());
 
   if (!err.empty()) {
     std::cerr << err << std::endl;
     std::cerr << "Failed to load OBJ file " << obj_file << "!" << std::endl;
-    return;
+    return false;
+  }
+  if (shapes.empty()) {
+    std::cerr << "OBJ file " << obj_file << " has no faces!" << std::endl;
+    return false;
   }
-  tinyobj::mesh_t mesh = shapes[0].mesh;
 
-  // Activate the program
-  program->Use();
+  // Interleave vertices of all shapes and group indices by material
+  data.packed = PackMesh(shapes, data.materials.size(), format);
+  shapes.clear();
 
-  // Generate a vertex array object
-  glGenVertexArrays(1, &this->vao);
-  glBindVertexArray(this->vao);
-
-  // --- Vertex positions ---
-  std::vector<GLfloat> vertex_buffer;
-  for (int i = 0; i < (int)mesh.positions.size() / 3; i++) {
-    vertex_buffer.push_back(mesh.positions[3 * i + 0]); // X
-    vertex_buffer.push_back(mesh.positions[3 * i + 1]); // Y
-    vertex_buffer.push_back(mesh.positions[3 * i + 2]); // Z
-  }
+  // Reorder for the post-transform vertex cache and vertex fetch
+  OptimizePackedMesh(data.packed, optimize);
 
-  // Generate and upload a buffer with vertex positions to GPU
-  glGenBuffers(1, &this->vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-  glBufferData(GL_ARRAY_BUFFER, vertex_buffer.size() * sizeof(GLfloat),
-               vertex_buffer.data(), GL_STATIC_DRAW);
-
-  // Bind the buffer to "Position" attribute in program
-  auto position_attrib = program->GetAttribLocation("Position");
-  glEnableVertexAttribArray(position_attrib);
-  glVertexAttribPointer(position_attrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-  // --- Texture coordinates ---
-  std::vector<GLfloat> texcoord_buffer;
-  for (int i = 0; i < (int)mesh.texcoords.size() / 2; i++) {
-    texcoord_buffer.push_back(mesh.texcoords[2 * i + 0]); // U
-    texcoord_buffer.push_back(mesh.texcoords[2 * i + 1]); // V
-  }
+  // Bounding volumes for culling, positions are floats in all vertex formats
+  data.bounds = ComputeBounds(data.packed.vertices.data(), data.packed.vertex_count, data.packed.layout.stride,
+                              data.packed.layout.position_offset);
 
-  // Generate and upload a buffer with texture coordinates to GPU
-  glGenBuffers(1, &this->tbo);
-  glBindBuffer(GL_ARRAY_BUFFER, this->tbo);
-  glBufferData(GL_ARRAY_BUFFER, texcoord_buffer.size() * sizeof(GLfloat),
-               texcoord_buffer.data(), GL_STATIC_DRAW);
-
-  // Bind the buffer to "TexCoord" attribute in program
-  if (mesh.texcoords.size() > 0) {
-    auto texcoord_attrib = program->GetAttribLocation("TexCoord");
-    glEnableVertexAttribArray(texcoord_attrib);
-    glVertexAttribPointer(texcoord_attrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
-  } else {
+  if (!data.packed.has_texcoords) {
     std::cout << "Warning: OBJ file " << obj_file
               << " has no texture coordinates!" << std::endl;
   }
+  if (!data.packed.has_normals) {
+    std::cout << "Warning: OBJ file " << obj_file
+    << " has no normals!" << std::endl;
+  }
+  return true;
+}
 
-  // --- Normals ---
-  std::vector<GLfloat> normal_buffer;
-  for (int i = 0; i < (int)mesh.normals.size() / 3; i++) {
-    normal_buffer.push_back(mesh.normals[3 * i + 0]); // X
-    normal_buffer.push_back(mesh.normals[3 * i + 1]); // Y
-    normal_buffer.push_back(mesh.normals[3 * i + 2]); // Z
+void Mesh::Upload(MeshData &data) {
+  auto &packed = data.packed;
+  auto indices = GetPackedIndices(packed);
+  this->cache_stats = SimulateVertexCache(indices.data(), indices.size(), packed.vertex_count);
+  this->materials.swap(data.materials);
+  this->bounds = data.bounds;
+
+  this->mesh_indices_count = (int) packed.index_count;
+  this->index_size = (GLsizei) packed.index_size;
+  this->index_type = packed.index_size == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  this->submeshes.clear();
+  for (auto &range : packed.ranges) {
+    Submesh submesh;
+    submesh.name = range.name;
+    submesh.material_id = range.material_id;
+    submesh.index_offset = (GLsizei) range.index_offset;
+    submesh.index_count = (GLsizei) range.index_count;
+    this->submeshes.push_back(submesh);
   }
 
-  // Generate and upload a buffer with texture coordinates to GPU
-  glGenBuffers(1, &this->nbo);
-  glBindBuffer(GL_ARRAY_BUFFER, this->nbo);
-  glBufferData(GL_ARRAY_BUFFER, normal_buffer.size() * sizeof(GLfloat),
-               normal_buffer.data(), GL_STATIC_DRAW);
-
-  // Bind the buffer to "Normal" attribute in program
-  if (mesh.normals.size() > 0) {
-    auto normal_attib = program->GetAttribLocation("Normal");
-    glEnableVertexAttribArray(normal_attib);
-    glVertexAttribPointer(normal_attib, 3, GL_FLOAT, GL_FALSE, 0, 0);
+  // Generate a vertex array object
+  glGenVertexArrays(1, &this->vao);
+  GLState::Get().BindVertexArray(this->vao);
+
+  // Generate and upload a buffer with interleaved vertices to GPU
+  glGenBuffers(1, &this->vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+  glBufferData(GL_ARRAY_BUFFER, packed.vertices.size(), packed.vertices.data(), GL_STATIC_DRAW);
+
+  // Bind the buffer to "Position", "TexCoord" and "Normal" attribute locations shared by all programs
+  SetAttribPointer(ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, packed, packed.layout.position_offset);
+  if (packed.format == VertexFormat::Quantized) {
+    SetAttribPointer(ATTRIBUTE_TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, packed, packed.layout.texcoord_offset);
+    SetAttribPointer(ATTRIBUTE_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, packed, packed.layout.normal_offset);
   } else {
-    std::cout << "Warning: OBJ file " << obj_file
-    << " has no normals!" << std::endl;
+    SetAttribPointer(ATTRIBUTE_TEXCOORD, 2, GL_FLOAT, GL_FALSE, packed, packed.layout.texcoord_offset);
+    SetAttribPointer(ATTRIBUTE_NORMAL, 3, GL_FLOAT, GL_FALSE, packed, packed.layout.normal_offset);
   }
 
   // --- Indices (define which triangles consists of which vertices) ---
-  std::vector<GLuint> index_data;
-  this->mesh_indices_count = (int)mesh.indices.size();
-  for (int i = 0; i < (int)mesh.indices.size(); i++) {
-    index_data.push_back(mesh.indices[i]);
-  }
-
   // Generate and upload a buffer with indices to GPU
   glGenBuffers(1, &this->ibo);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_data.size() * sizeof(GLuint),
-               index_data.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.indices.size(), packed.indices.data(), GL_STATIC_DRAW);
+  this->memory_size = packed.vertices.size() + packed.indices.size();
 
   // Complete the vertex array object
 //  glBindVertexArray(0);
 }
 
+bool Mesh::IsLoaded() const {
+  return this->vao != 0;
+}
+
+unsigned int Mesh::GetId() const {
+  return this->id;
+}
+
 void Mesh::Render() {
-  // Draw object
-  glBindVertexArray(this->vao);
-  glDrawElements(GL_TRIANGLES, this->mesh_indices_count, GL_UNSIGNED_INT, 0);
+  // Placeholders are not drawn until their data is uploaded
+  if (!this->vao) return;
+
+  // Draw object, submeshes are contiguous so a single call covers all of them
+  GLState::Get().BindVertexArray(this->vao);
+  glDrawElements(GL_TRIANGLES, this->mesh_indices_count, this->index_type, 0);
+  GLState::Get().CountDraw();
 //  glBindVertexArray(0);
 }
+
+void Mesh::Render(const MaterialCallback &setMaterial) {
+  if (!this->vao) return;
+
+  // Draw object, material state changes only between submeshes
+  GLState::Get().BindVertexArray(this->vao);
+  for (auto &submesh : this->submeshes) {
+    const tinyobj::material_t *material = nullptr;
+    if (submesh.material_id >= 0) material = &this->materials[submesh.material_id];
+    setMaterial(submesh, material);
+    glDrawElements(GL_TRIANGLES, submesh.index_count, this->index_type,
+                   (const GLvoid *) (size_t) (submesh.index_offset * this->index_size));
+    GLState::Get().CountDraw();
+  }
+//  glBindVertexArray(0);
+}
+
+void Mesh::RenderInstanced(const MeshInstance *instances, size_t count) {
+  if (!this->vao || count == 0) return;
+  GLState::Get().BindVertexArray(this->vao);
+
+  // The instance buffer is attached to the vertex array object on first use
+  if (!this->instance_vbo) {
+    glGenBuffers(1, &this->instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instance_vbo);
+    for (GLuint column = 0; column < 4; column++) {
+      GLuint location = ATTRIBUTE_INSTANCE_MODEL + column;
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+                            (const GLvoid *) (offsetof(MeshInstance, modelMatrix) + column * sizeof(glm::vec4)));
+      glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(ATTRIBUTE_INSTANCE_DATA);
+    glVertexAttribPointer(ATTRIBUTE_INSTANCE_DATA, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+                          (const GLvoid *) offsetof(MeshInstance, data));
+    glVertexAttribDivisor(ATTRIBUTE_INSTANCE_DATA, 1);
+  } else {
+    glBindBuffer(GL_ARRAY_BUFFER, this->instance_vbo);
+  }
+
+  // Orphan the previous storage so the draws still reading it do not stall the upload
+  this->instance_capacity = std::max(this->instance_capacity, count);
+  glBufferData(GL_ARRAY_BUFFER, this->instance_capacity * sizeof(MeshInstance), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(MeshInstance), instances);
+
+  glDrawElementsInstanced(GL_TRIANGLES, this->mesh_indices_count, this->index_type, 0, (GLsizei) count);
+  GLState::Get().CountDraw();
+}
+
+const std::vector<Mesh::Submesh> &Mesh::GetSubmeshes() const {
+  return this->submeshes;
+}
+
+const std::vector<tinyobj::material_t> &Mesh::GetMaterials() const {
+  return this->materials;
+}
+
+const VertexCacheStats &Mesh::GetVertexCacheStats() const {
+  return this->cache_stats;
+}
+
+size_t Mesh::GetMemorySize() const {
+  return this->memory_size;
+}
+
+const Bounds &Mesh::GetBounds() const {
+  return this->bounds;
+}
@@ -5,6 +5,7 @@
 #include <vector>
 #include <fstream>
 #include <memory>
+#include <functional>
 
 #include <GL/glew.h>
 #include <glm/mat4x4.hpp>
@@ -14,22 +15,98 @@
 #include "shader.h"
 #include "texture.h"
 #include "tiny_obj_loader.h"
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+#include "frustum.h"
 
+// Per-instance attributes of Mesh::RenderInstanced
+// Shaders read them as "InstanceModelMatrix" and "InstanceData", data holds free parameters such as transparency
+struct MeshInstance {
+  glm::mat4 modelMatrix;
+  glm::vec4 data;
+};
+
+// Mesh loaded from an OBJ file
+// All shapes of the file share one interleaved vertex buffer and one index buffer
+// Indices are grouped by material, each group is a submesh with its own index range
+// Triangles and vertices are reordered at load for the vertex cache, see MeshOptimizeFlags
 class Mesh {
+public:
+  // Range of the index buffer drawn with a single material
+  struct Submesh {
+    std::string name;   // name of the first shape in the range
+    int material_id;    // index into materials, -1 if the faces have no material
+    GLsizei index_offset;
+    GLsizei index_count;
+  };
+
+  // Called before a submesh is drawn, material is nullptr for faces without material
+  typedef std::function<void(const Submesh &submesh, const tinyobj::material_t *material)> MaterialCallback;
+
+  // CPU side data of a mesh, produced by Load and consumed by Upload
+  struct MeshData {
+    PackedMesh packed;
+    std::vector<tinyobj::material_t> materials;
+    Bounds bounds;
+  };
+
+  // Empty placeholder that draws nothing until data is uploaded
+  Mesh();
+  // Attributes are bound to the fixed ShaderAttribute locations, the mesh works with any shader
+  Mesh(const std::string &obj, VertexFormat format = VertexFormat::Float, unsigned int optimize = OPTIMIZE_DEFAULT);
+  Mesh(ShaderPtr program, const std::string &obj, VertexFormat format = VertexFormat::Float,
+       unsigned int optimize = OPTIMIZE_DEFAULT);
+  Mesh(ShaderPtr program, const std::string &obj, const TexturePtr texture);
+  // Deletes the vertex array and the buffers
+  ~Mesh();
+
+  // Loads, packs and optimizes an OBJ file without touching OpenGL, safe to call from any thread
+  static bool Load(const std::string &obj, VertexFormat format, unsigned int optimize, MeshData &data);
+  // Creates the GPU buffers from loaded data, must run on the thread owning the OpenGL context
+  void Upload(MeshData &data);
+  bool IsLoaded() const;
+  // Unique number of the mesh in this process, used to sort draws by vertex array
+  unsigned int GetId() const;
+
+  // Draws all submeshes with a single draw call
+  void Render();
+  // Draws submeshes one by one, calling setMaterial before each of them
+  void Render(const MaterialCallback &setMaterial);
+  // Draws all instances with a single instanced draw call, instance data is streamed to a buffer owned by the mesh
+  void RenderInstanced(const MeshInstance *instances, size_t count);
+
+  const std::vector<Submesh> &GetSubmeshes() const;
+  const std::vector<tinyobj::material_t> &GetMaterials() const;
+  // Simulated post-transform vertex cache efficiency of the uploaded index buffer
+  const VertexCacheStats &GetVertexCacheStats() const;
+  // Size of the vertex and index buffers in bytes
+  size_t GetMemorySize() const;
+  // Model space bounds of all vertices, empty at the origin until the data is uploaded
+  const Bounds &GetBounds() const;
+
+private:
+  // Meshes own OpenGL objects, do not copy them
+  Mesh(const Mesh &) = delete;
+  Mesh &operator=(const Mesh &) = delete;
+
   GLuint vao;
-  GLuint vbo, tbo, nbo;
+  GLuint vbo;
   GLuint ibo;
+  GLuint instance_vbo;
+  size_t instance_capacity;
+  GLenum index_type;
+  GLsizei index_size;
   ShaderPtr program;
   TexturePtr texture;
   int mesh_indices_count;
+  std::vector<Submesh> submeshes;
+  std::vector<tinyobj::material_t> materials;
+  VertexCacheStats cache_stats;
+  size_t memory_size;
+  Bounds bounds;
+  unsigned int id;
 
-  void initGeometry(const std::string &);
   void initTexture(const std::string &, unsigned int, unsigned int);
-
-public:
-  Mesh(ShaderPtr program, const std::string &obj);
-  Mesh(ShaderPtr program, const std::string &obj, const TexturePtr texture);
-  void Render();
 };
 typedef std::shared_ptr< Mesh > MeshPtr;
 
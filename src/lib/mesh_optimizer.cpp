@@ -0,0 +1,324 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "mesh_optimizer.h"
+
+VertexCacheStats SimulateVertexCache(const uint32_t *indices, size_t index_count, size_t vertex_count,
+                                     unsigned int cache_size) {
+  VertexCacheStats stats;
+  stats.triangles = index_count / 3;
+  stats.vertices = 0;
+  stats.transformed = 0;
+
+  // A vertex is in the FIFO while fewer than cache_size vertices were transformed after it
+  std::vector<size_t> timestamps(vertex_count, 0);
+  std::vector<bool> referenced(vertex_count, false);
+  for (size_t i = 0; i < stats.triangles * 3; i++) {
+    uint32_t vertex = indices[i];
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      stats.vertices++;
+    }
+    if (timestamps[vertex] == 0 || stats.transformed - timestamps[vertex] >= cache_size)
+      timestamps[vertex] = ++stats.transformed;
+  }
+
+  stats.acmr = stats.triangles ? (double) stats.transformed / (double) stats.triangles : 0.0;
+  stats.atvr = stats.vertices ? (double) stats.transformed / (double) stats.vertices : 0.0;
+  return stats;
+}
+
+// Forsyth's vertex scoring, see "Linear-Speed Vertex Cache Optimisation" by Tom Forsyth
+// The optimizer models a larger LRU cache than the FIFO it targets, the scores favour the most recent vertices anyway
+const int FORSYTH_CACHE_SIZE = 32;
+const int FORSYTH_VALENCE_TABLE_SIZE = 32;
+
+static float ForsythScore(int cache_position, unsigned int remaining) {
+  if (remaining == 0) return -1.0f;
+
+  float score = 0.0f;
+  if (cache_position >= 0) {
+    // The last triangle was just drawn, its vertices get a fixed score so it is not repeated
+    if (cache_position < 3)
+      score = 0.75f;
+    else
+      score = std::pow(1.0f - (float) (cache_position - 3) / (float) (FORSYTH_CACHE_SIZE - 3), 1.5f);
+  }
+
+  // Boost vertices with few triangles left so they are finished off early
+  score += 2.0f / std::sqrt((float) remaining);
+  return score;
+}
+
+struct ForsythScoreTable {
+  float scores[FORSYTH_CACHE_SIZE + 1][FORSYTH_VALENCE_TABLE_SIZE];
+
+  ForsythScoreTable() {
+    for (int position = -1; position < FORSYTH_CACHE_SIZE; position++)
+      for (int remaining = 0; remaining < FORSYTH_VALENCE_TABLE_SIZE; remaining++)
+        scores[position + 1][remaining] = ForsythScore(position, (unsigned int) remaining);
+  }
+
+  float Get(int position, unsigned int remaining) const {
+    if (remaining < FORSYTH_VALENCE_TABLE_SIZE) return scores[position + 1][remaining];
+    return ForsythScore(position, remaining);
+  }
+};
+
+void OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count) {
+  static const ForsythScoreTable table;
+  size_t triangle_count = index_count / 3;
+  if (triangle_count == 0) return;
+
+  // Triangles adjacent to each vertex, emitted triangles are swapped behind the remaining ones
+  std::vector<uint32_t> remaining(vertex_count, 0);
+  for (size_t i = 0; i < triangle_count * 3; i++) remaining[indices[i]]++;
+  std::vector<size_t> adjacency_offsets(vertex_count + 1, 0);
+  for (size_t v = 0; v < vertex_count; v++) adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining[v];
+  std::vector<uint32_t> adjacency(triangle_count * 3);
+  {
+    std::vector<size_t> next(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t i = 0; i < triangle_count * 3; i++) adjacency[next[indices[i]]++] = (uint32_t) (i / 3);
+  }
+
+  std::vector<int> cache_positions(vertex_count, -1);
+  std::vector<float> vertex_scores(vertex_count);
+  for (size_t v = 0; v < vertex_count; v++) vertex_scores[v] = table.Get(-1, remaining[v]);
+
+  std::vector<float> triangle_scores(triangle_count);
+  std::vector<bool> emitted(triangle_count, false);
+  size_t best = 0;
+  for (size_t t = 0; t < triangle_count; t++) {
+    triangle_scores[t] = vertex_scores[indices[3 * t]] + vertex_scores[indices[3 * t + 1]] +
+                         vertex_scores[indices[3 * t + 2]];
+    if (triangle_scores[t] > triangle_scores[best]) best = t;
+  }
+
+  std::vector<uint32_t> cache, next_cache;
+  cache.reserve(FORSYTH_CACHE_SIZE + 3);
+  next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+  std::vector<uint32_t> output(triangle_count * 3);
+  size_t cursor = 0;
+
+  for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+    // Without candidates in the cache continue with the first triangle that is left
+    if (best == triangle_count) {
+      while (emitted[cursor]) cursor++;
+      best = cursor;
+    }
+
+    const uint32_t *triangle = indices + 3 * best;
+    memcpy(&output[3 * emitted_count], triangle, 3 * sizeof(uint32_t));
+    emitted[best] = true;
+
+    // Remove the triangle from the adjacency of its vertices
+    for (int k = 0; k < 3; k++) {
+      uint32_t vertex = triangle[k];
+      uint32_t *begin = &adjacency[adjacency_offsets[vertex]];
+      uint32_t *end = begin + remaining[vertex];
+      uint32_t *it = std::find(begin, end, (uint32_t) best);
+      std::swap(*it, *(end - 1));
+      remaining[vertex]--;
+    }
+
+    // Vertices of the triangle move to the front of the cache
+    next_cache.assign(triangle, triangle + 3);
+    for (auto vertex : cache)
+      if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) next_cache.push_back(vertex);
+
+    // Rescore every vertex that was or is in the cache
+    for (size_t i = 0; i < next_cache.size(); i++) {
+      uint32_t vertex = next_cache[i];
+      int position = i < (size_t) FORSYTH_CACHE_SIZE ? (int) i : -1;
+      cache_positions[vertex] = position;
+      float score = table.Get(position, remaining[vertex]);
+      float delta = score - vertex_scores[vertex];
+      vertex_scores[vertex] = score;
+      for (size_t a = 0; a < remaining[vertex]; a++) triangle_scores[adjacency[adjacency_offsets[vertex] + a]] += delta;
+    }
+    if (next_cache.size() > (size_t) FORSYTH_CACHE_SIZE) next_cache.resize(FORSYTH_CACHE_SIZE);
+    cache.swap(next_cache);
+
+    // Next triangle is the best one using a cached vertex
+    best = triangle_count;
+    float best_score = -1.0f;
+    for (auto vertex : cache) {
+      for (size_t a = 0; a < remaining[vertex]; a++) {
+        uint32_t candidate = adjacency[adjacency_offsets[vertex] + a];
+        if (triangle_scores[candidate] > best_score) {
+          best_score = triangle_scores[candidate];
+          best = candidate;
+        }
+      }
+    }
+  }
+
+  memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+// Position of a packed vertex
+static inline void GetPosition(const uint8_t *vertices, size_t stride, uint32_t vertex, float position[3]) {
+  memcpy(position, vertices + vertex * stride, 3 * sizeof(float));
+}
+
+void OptimizeOverdraw(uint32_t *indices, size_t index_count, const uint8_t *vertices, size_t stride,
+                      size_t vertex_count, double threshold) {
+  size_t triangle_count = index_count / 3;
+  if (triangle_count < 2) return;
+  auto original_stats = SimulateVertexCache(indices, triangle_count * 3, vertex_count);
+
+  // Clusters start where all vertices of a triangle miss the cache, the order is restarted there anyway
+  // Long clusters are also split wherever their own ACMR is already within threshold of the whole range
+  std::vector<size_t> cluster_starts;
+  std::vector<size_t> timestamps(vertex_count, 0);
+  size_t transformed = 0, cluster_transformed = 0, cluster_start = 0;
+  for (size_t t = 0; t < triangle_count; t++) {
+    int misses = 0;
+    for (int k = 0; k < 3; k++) {
+      uint32_t vertex = indices[3 * t + k];
+      if (timestamps[vertex] == 0 || transformed - timestamps[vertex] >= VERTEX_CACHE_SIZE) {
+        timestamps[vertex] = ++transformed;
+        misses++;
+      }
+    }
+
+    size_t cluster_triangles = t - cluster_start;
+    bool hard = misses == 3;
+    bool soft = cluster_triangles >= 16 &&
+                (double) cluster_transformed / (double) cluster_triangles <= original_stats.acmr * threshold;
+    if (t == 0 || hard || soft) {
+      cluster_starts.push_back(t);
+      cluster_start = t;
+      cluster_transformed = 0;
+    }
+    cluster_transformed += (size_t) misses;
+  }
+  cluster_starts.push_back(triangle_count);
+  size_t cluster_count = cluster_starts.size() - 1;
+  if (cluster_count < 2) return;
+
+  // Area weighted centroid and normal of each cluster
+  struct Cluster {
+    size_t start, end;
+    float centroid[3], normal[3], area;
+    float sort_key;
+  };
+  std::vector<Cluster> clusters(cluster_count);
+  float mesh_centroid[3] = {0.0f, 0.0f, 0.0f};
+  float mesh_area = 0.0f;
+  for (size_t c = 0; c < cluster_count; c++) {
+    Cluster &cluster = clusters[c];
+    cluster.start = cluster_starts[c];
+    cluster.end = cluster_starts[c + 1];
+    cluster.area = 0.0f;
+    for (int k = 0; k < 3; k++) cluster.centroid[k] = cluster.normal[k] = 0.0f;
+
+    for (size_t t = cluster.start; t < cluster.end; t++) {
+      float p0[3], p1[3], p2[3];
+      GetPosition(vertices, stride, indices[3 * t], p0);
+      GetPosition(vertices, stride, indices[3 * t + 1], p1);
+      GetPosition(vertices, stride, indices[3 * t + 2], p2);
+      float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+      float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+      for (int k = 0; k < 3; k++) {
+        cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+        cluster.normal[k] += normal[k];
+      }
+      cluster.area += area;
+    }
+
+    for (int k = 0; k < 3; k++) mesh_centroid[k] += cluster.centroid[k];
+    mesh_area += cluster.area;
+    if (cluster.area > 0.0f)
+      for (int k = 0; k < 3; k++) cluster.centroid[k] /= cluster.area;
+  }
+  if (mesh_area > 0.0f)
+    for (int k = 0; k < 3; k++) mesh_centroid[k] /= mesh_area;
+
+  // Clusters facing away from the center are likely in front of the others, draw them first
+  for (auto &cluster : clusters) {
+    float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] +
+                             cluster.normal[2] * cluster.normal[2]);
+    cluster.sort_key = 0.0f;
+    if (length > 0.0f)
+      for (int k = 0; k < 3; k++) cluster.sort_key += (cluster.centroid[k] - mesh_centroid[k]) * cluster.normal[k] / length;
+  }
+  std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) {
+    return a.sort_key > b.sort_key;
+  });
+
+  std::vector<uint32_t> output;
+  output.reserve(triangle_count * 3);
+  for (auto &cluster : clusters)
+    output.insert(output.end(), indices + 3 * cluster.start, indices + 3 * cluster.end);
+
+  // Keep the input order if the clusters cost too much vertex cache efficiency
+  auto sorted_stats = SimulateVertexCache(output.data(), output.size(), vertex_count);
+  if (sorted_stats.acmr > original_stats.acmr * threshold) return;
+  memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(uint32_t *indices, size_t index_count, size_t vertex_count) {
+  const uint32_t UNUSED = 0xFFFFFFFFu;
+  std::vector<uint32_t> remap(vertex_count, UNUSED);
+
+  uint32_t next = 0;
+  for (size_t i = 0; i < index_count; i++) {
+    uint32_t &vertex = remap[indices[i]];
+    if (vertex == UNUSED) vertex = next++;
+    indices[i] = vertex;
+  }
+  for (auto &vertex : remap)
+    if (vertex == UNUSED) vertex = next++;
+
+  return remap;
+}
+
+std::vector<uint32_t> GetPackedIndices(const PackedMesh &packed) {
+  std::vector<uint32_t> indices(packed.index_count);
+  if (packed.index_size == sizeof(uint16_t)) {
+    auto source = (const uint16_t *) packed.indices.data();
+    for (size_t i = 0; i < packed.index_count; i++) indices[i] = source[i];
+  } else {
+    memcpy(indices.data(), packed.indices.data(), packed.index_count * sizeof(uint32_t));
+  }
+  return indices;
+}
+
+void SetPackedIndices(PackedMesh &packed, const std::vector<uint32_t> &indices) {
+  if (packed.index_size == sizeof(uint16_t)) {
+    auto target = (uint16_t *) packed.indices.data();
+    for (size_t i = 0; i < packed.index_count; i++) target[i] = (uint16_t) indices[i];
+  } else {
+    memcpy(packed.indices.data(), indices.data(), packed.index_count * sizeof(uint32_t));
+  }
+}
+
+void OptimizePackedMesh(PackedMesh &packed, unsigned int flags) {
+  if (flags == OPTIMIZE_NONE || packed.index_count == 0) return;
+  auto indices = GetPackedIndices(packed);
+
+  // Triangles never move between material ranges
+  for (auto &range : packed.ranges) {
+    uint32_t *range_indices = indices.data() + range.index_offset;
+    if (flags & OPTIMIZE_VERTEX_CACHE)
+      OptimizeVertexCache(range_indices, range.index_count, packed.vertex_count);
+    if (flags & OPTIMIZE_OVERDRAW)
+      OptimizeOverdraw(range_indices, range.index_count, packed.vertices.data() + packed.layout.position_offset,
+                       packed.layout.stride, packed.vertex_count);
+  }
+
+  if (flags & OPTIMIZE_VERTEX_FETCH) {
+    auto remap = OptimizeVertexFetch(indices.data(), indices.size(), packed.vertex_count);
+    std::vector<uint8_t> vertices(packed.vertices.size());
+    size_t stride = packed.layout.stride;
+    for (size_t v = 0; v < packed.vertex_count; v++)
+      memcpy(&vertices[remap[v] * stride], &packed.vertices[v * stride], stride);
+    packed.vertices.swap(vertices);
+  }
+
+  SetPackedIndices(packed, indices);
+}
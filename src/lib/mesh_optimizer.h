@@ -0,0 +1,60 @@
+#ifndef PPGSO_MESH_OPTIMIZER_H
+#define PPGSO_MESH_OPTIMIZER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "vertex_format.h"
+
+// Triangle and vertex reordering for faster rendering of loaded meshes
+// - Vertex cache: triangles are reordered with Forsyth's algorithm so vertices are reused while still in the post-transform cache
+// - Overdraw: cache friendly clusters of triangles are sorted so faces pointing away from the mesh center are drawn first
+// - Vertex fetch: vertices are renumbered in the order they are first used so vertex memory is read sequentially
+// All passes only reorder data, the rendered image stays the same
+enum MeshOptimizeFlags {
+  OPTIMIZE_NONE = 0,
+  OPTIMIZE_VERTEX_CACHE = 1,
+  OPTIMIZE_OVERDRAW = 2,
+  OPTIMIZE_VERTEX_FETCH = 4,
+  OPTIMIZE_DEFAULT = OPTIMIZE_VERTEX_CACHE | OPTIMIZE_VERTEX_FETCH
+};
+
+// Post-transform vertex cache size assumed by the optimizer and the simulator
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+// Result of a FIFO post-transform vertex cache simulation
+// ACMR: transformed vertices per triangle, 0.5 is ideal for large regular meshes, 3 is the worst case
+// ATVR: transformed vertices per referenced vertex, 1 is ideal
+struct VertexCacheStats {
+  size_t triangles;
+  size_t vertices;
+  size_t transformed;
+  double acmr;
+  double atvr;
+};
+
+// Simulates a FIFO vertex cache of cache_size entries for triangle list indices
+VertexCacheStats SimulateVertexCache(const uint32_t *indices, size_t index_count, size_t vertex_count,
+                                     unsigned int cache_size = VERTEX_CACHE_SIZE);
+
+// Reorders triangles of a triangle list for vertex cache locality
+void OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count);
+
+// Reorders clusters of triangles to reduce overdraw, positions are 3 floats at the start of each vertex
+// Clusters are formed at cache restarts so the vertex cache efficiency stays within threshold of the input order
+void OptimizeOverdraw(uint32_t *indices, size_t index_count, const uint8_t *vertices, size_t stride,
+                      size_t vertex_count, double threshold = 1.05);
+
+// Renumbers vertices in order of first use, returns the new index of each old vertex
+// Vertices that are not referenced are moved to the end
+std::vector<uint32_t> OptimizeVertexFetch(uint32_t *indices, size_t index_count, size_t vertex_count);
+
+// Applies the selected passes to a packed mesh, each material range is reordered on its own
+void OptimizePackedMesh(PackedMesh &packed, unsigned int flags);
+
+// Reads and writes indices of a packed mesh as 32bit values
+std::vector<uint32_t> GetPackedIndices(const PackedMesh &packed);
+void SetPackedIndices(PackedMesh &packed, const std::vector<uint32_t> &indices);
+
+#endif // PPGSO_MESH_OPTIMIZER_H
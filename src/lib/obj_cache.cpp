@@ -0,0 +1,302 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+
+#include "obj_cache.h"
+#include "mapped_file.h"
+
+// File layout, all values are 32bit in native byte order and aligned to 4 bytes:
+//   header:   magic "PPGSOOBJ", version, byte order mark, MTL base path, sources, shape count, material count
+//   source:   MTL name, 64bit modification time, 64bit size
+//   shape:    name, positions, normals, texcoords, indices, material_ids
+//   material: name, 5 colors, shininess, ior, dissolve, illum, 7 texture names, unknown parameters
+// Strings are stored as length + characters padded to 4 bytes, arrays as element count + elements
+static const char OBJ_CACHE_MAGIC[8] = {'P', 'P', 'G', 'S', 'O', 'O', 'B', 'J'};
+static const uint32_t OBJ_CACHE_BYTE_ORDER = 0x01020304;
+
+// Appends cache records to a stream
+class CacheWriter {
+public:
+  CacheWriter(std::ostream &stream) : stream(stream) {}
+
+  void Write(const void *data, size_t size) {
+    stream.write((const char *) data, size);
+  }
+
+  void WriteUInt(uint32_t value) {
+    Write(&value, sizeof(value));
+  }
+
+  void WriteInt64(int64_t value) {
+    Write(&value, sizeof(value));
+  }
+
+  void WriteString(const std::string &value) {
+    static const char padding[4] = {0, 0, 0, 0};
+    WriteUInt((uint32_t) value.size());
+    Write(value.data(), value.size());
+    Write(padding, (4 - value.size() % 4) % 4);
+  }
+
+  template<typename T>
+  void WriteArray(const std::vector<T> &values) {
+    static_assert(sizeof(T) == 4, "Cache arrays must have 32bit elements");
+    WriteUInt((uint32_t) values.size());
+    Write(values.data(), values.size() * sizeof(T));
+  }
+
+private:
+  std::ostream &stream;
+};
+
+// Reads cache records from a memory mapped range, every read is bounds checked
+class CacheReader {
+public:
+  CacheReader(const char *data, size_t size) : current(data), end(data + size), valid(data != nullptr) {}
+
+  bool IsValid() const { return valid; }
+
+  bool Read(void *data, size_t size) {
+    if (!valid || (size_t) (end - current) < size) return valid = false;
+    memcpy(data, current, size);
+    current += size;
+    return true;
+  }
+
+  uint32_t ReadUInt() {
+    uint32_t value = 0;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  int64_t ReadInt64() {
+    int64_t value = 0;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  std::string ReadString() {
+    size_t length = ReadUInt();
+    size_t padded = length + (4 - length % 4) % 4;
+    if (!valid || (size_t) (end - current) < padded) {
+      valid = false;
+      return std::string();
+    }
+    std::string value(current, length);
+    current += padded;
+    return value;
+  }
+
+  template<typename T>
+  void ReadArray(std::vector<T> &values) {
+    static_assert(sizeof(T) == 4, "Cache arrays must have 32bit elements");
+    size_t count = ReadUInt();
+    if (!valid || (size_t) (end - current) / sizeof(T) < count) {
+      valid = false;
+      return;
+    }
+    values.resize(count);
+    Read(values.data(), count * sizeof(T));
+  }
+
+private:
+  const char *current;
+  const char *end;
+  bool valid;
+};
+
+// Current modification time and size of a source file
+static ObjCacheSource GetSource(const std::string &file, const std::string &mtl_name) {
+  return {mtl_name, MappedFile::GetModificationTime(file), MappedFile::GetFileSize(file)};
+}
+
+// Reads MTL files as tinyobj::LoadObjMapped does and records each one as a source before reading it
+class SourceMaterialReader : public tinyobj::MaterialFileReader {
+public:
+  SourceMaterialReader(const std::string &mtl_basepath, std::vector<ObjCacheSource> &sources)
+      : MaterialFileReader(mtl_basepath), mtl_basepath(mtl_basepath), sources(sources) {}
+
+  std::string operator()(const std::string &matId, std::vector<tinyobj::material_t> &materials,
+                         std::map<std::string, int> &matMap) override {
+    sources.push_back(GetSource(mtl_basepath + matId, matId));
+    return MaterialFileReader::operator()(matId, materials, matMap);
+  }
+
+private:
+  std::string mtl_basepath;
+  std::vector<ObjCacheSource> &sources;
+};
+
+std::string GetObjCachePath(const std::string &obj_file) {
+  return obj_file + ".cache";
+}
+
+std::string LoadObjCached(std::vector<tinyobj::shape_t> &shapes,
+                          std::vector<tinyobj::material_t> &materials,
+                          const std::string &obj_file, const char *mtl_basepath) {
+  auto cache_file = GetObjCachePath(obj_file);
+  if (ReadObjCache(shapes, materials, cache_file, obj_file, mtl_basepath)) return "";
+
+  // Sources are recorded before they are read, a change during the parse makes the next run parse again
+  std::vector<ObjCacheSource> sources{GetSource(obj_file, "")};
+  MappedFile file{obj_file};
+  if (!file.IsOpen()) return "Cannot open file [" + obj_file + "]\n";
+  SourceMaterialReader reader{mtl_basepath ? mtl_basepath : "", sources};
+  auto err = tinyobj::LoadObj(shapes, materials, file.Data(), file.Size(), reader);
+  if (!err.empty()) return err;
+
+  // Failing to write the cache is not an error, the next run will simply parse again
+  WriteObjCache(shapes, materials, cache_file, mtl_basepath, sources);
+  return "";
+}
+
+bool ReadObjCache(std::vector<tinyobj::shape_t> &shapes,
+                  std::vector<tinyobj::material_t> &materials,
+                  const std::string &cache_file, const std::string &obj_file,
+                  const char *mtl_basepath) {
+  MappedFile file{cache_file};
+  if (!file.IsOpen()) return false;
+
+  CacheReader reader{file.Data(), file.Size()};
+
+  // Check the header
+  char magic[sizeof(OBJ_CACHE_MAGIC)];
+  if (!reader.Read(magic, sizeof(magic)) || memcmp(magic, OBJ_CACHE_MAGIC, sizeof(magic)) != 0) return false;
+  if (reader.ReadUInt() != OBJ_CACHE_VERSION) return false;
+  if (reader.ReadUInt() != OBJ_CACHE_BYTE_ORDER) return false;
+
+  // Every source must still have the recorded time and size, not just be older than the cache,
+  // so restored older files and MTL edits are noticed as well
+  std::string basepath = mtl_basepath ? mtl_basepath : "";
+  if (reader.ReadString() != basepath) return false;
+  size_t source_count = reader.ReadUInt();
+  for (size_t i = 0; i < source_count && reader.IsValid(); i++) {
+    auto mtl_name = reader.ReadString();
+    auto time = reader.ReadInt64();
+    auto size = reader.ReadInt64();
+    // The first source is the OBJ file
+    auto source = GetSource(i == 0 ? obj_file : basepath + mtl_name, mtl_name);
+    if (source.time != time || source.size != size) return false;
+  }
+  if (source_count == 0) return false;
+
+  size_t shape_count = reader.ReadUInt();
+  size_t material_count = reader.ReadUInt();
+  if (!reader.IsValid()) return false;
+
+  std::vector<tinyobj::shape_t> cached_shapes(shape_count);
+  for (auto &shape : cached_shapes) {
+    shape.name = reader.ReadString();
+    reader.ReadArray(shape.mesh.positions);
+    reader.ReadArray(shape.mesh.normals);
+    reader.ReadArray(shape.mesh.texcoords);
+    reader.ReadArray(shape.mesh.indices);
+    reader.ReadArray(shape.mesh.material_ids);
+    if (!reader.IsValid()) return false;
+  }
+
+  std::vector<tinyobj::material_t> cached_materials(material_count);
+  for (auto &material : cached_materials) {
+    material.name = reader.ReadString();
+    reader.Read(material.ambient, sizeof(material.ambient));
+    reader.Read(material.diffuse, sizeof(material.diffuse));
+    reader.Read(material.specular, sizeof(material.specular));
+    reader.Read(material.transmittance, sizeof(material.transmittance));
+    reader.Read(material.emission, sizeof(material.emission));
+    reader.Read(&material.shininess, sizeof(material.shininess));
+    reader.Read(&material.ior, sizeof(material.ior));
+    reader.Read(&material.dissolve, sizeof(material.dissolve));
+    material.illum = (int) reader.ReadUInt();
+    material.ambient_texname = reader.ReadString();
+    material.diffuse_texname = reader.ReadString();
+    material.specular_texname = reader.ReadString();
+    material.specular_highlight_texname = reader.ReadString();
+    material.bump_texname = reader.ReadString();
+    material.displacement_texname = reader.ReadString();
+    material.alpha_texname = reader.ReadString();
+    size_t parameter_count = reader.ReadUInt();
+    for (size_t i = 0; i < parameter_count && reader.IsValid(); i++) {
+      auto key = reader.ReadString();
+      material.unknown_parameter[key] = reader.ReadString();
+    }
+    if (!reader.IsValid()) return false;
+  }
+
+  // Only touch the output once the whole cache is known to be valid
+  shapes.swap(cached_shapes);
+  materials.swap(cached_materials);
+  return true;
+}
+
+bool WriteObjCache(const std::vector<tinyobj::shape_t> &shapes,
+                   const std::vector<tinyobj::material_t> &materials,
+                   const std::string &cache_file, const char *mtl_basepath,
+                   const std::vector<ObjCacheSource> &sources) {
+  // Write into a temporary file first so a concurrent reader never sees a partial cache
+  auto temporary_file = cache_file + ".tmp";
+  std::ofstream stream(temporary_file, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open()) return false;
+
+  CacheWriter writer{stream};
+  writer.Write(OBJ_CACHE_MAGIC, sizeof(OBJ_CACHE_MAGIC));
+  writer.WriteUInt(OBJ_CACHE_VERSION);
+  writer.WriteUInt(OBJ_CACHE_BYTE_ORDER);
+  writer.WriteString(mtl_basepath ? mtl_basepath : "");
+  writer.WriteUInt((uint32_t) sources.size());
+  for (auto &source : sources) {
+    writer.WriteString(source.mtl_name);
+    writer.WriteInt64(source.time);
+    writer.WriteInt64(source.size);
+  }
+  writer.WriteUInt((uint32_t) shapes.size());
+  writer.WriteUInt((uint32_t) materials.size());
+
+  for (auto &shape : shapes) {
+    writer.WriteString(shape.name);
+    writer.WriteArray(shape.mesh.positions);
+    writer.WriteArray(shape.mesh.normals);
+    writer.WriteArray(shape.mesh.texcoords);
+    writer.WriteArray(shape.mesh.indices);
+    writer.WriteArray(shape.mesh.material_ids);
+  }
+
+  for (auto &material : materials) {
+    writer.WriteString(material.name);
+    writer.Write(material.ambient, sizeof(material.ambient));
+    writer.Write(material.diffuse, sizeof(material.diffuse));
+    writer.Write(material.specular, sizeof(material.specular));
+    writer.Write(material.transmittance, sizeof(material.transmittance));
+    writer.Write(material.emission, sizeof(material.emission));
+    writer.Write(&material.shininess, sizeof(material.shininess));
+    writer.Write(&material.ior, sizeof(material.ior));
+    writer.Write(&material.dissolve, sizeof(material.dissolve));
+    writer.WriteUInt((uint32_t) material.illum);
+    writer.WriteString(material.ambient_texname);
+    writer.WriteString(material.diffuse_texname);
+    writer.WriteString(material.specular_texname);
+    writer.WriteString(material.specular_highlight_texname);
+    writer.WriteString(material.bump_texname);
+    writer.WriteString(material.displacement_texname);
+    writer.WriteString(material.alpha_texname);
+    writer.WriteUInt((uint32_t) material.unknown_parameter.size());
+    for (auto &parameter : material.unknown_parameter) {
+      writer.WriteString(parameter.first);
+      writer.WriteString(parameter.second);
+    }
+  }
+
+  stream.close();
+  if (!stream) {
+    std::remove(temporary_file.c_str());
+    return false;
+  }
+
+  // Rename does not replace existing files on all platforms
+  std::remove(cache_file.c_str());
+  if (std::rename(temporary_file.c_str(), cache_file.c_str()) != 0) {
+    std::remove(temporary_file.c_str());
+    return false;
+  }
+  return true;
+}
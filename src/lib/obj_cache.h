@@ -0,0 +1,48 @@
+#ifndef PPGSO_OBJ_CACHE_H
+#define PPGSO_OBJ_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "tiny_obj_loader.h"
+
+// Binary cache for parsed OBJ files
+// The cache holds the already deduplicated shapes and the materials produced by tinyobj::LoadObj
+// It is stored next to the source file and memory mapped on load, so no text parsing is needed
+// Bump the version whenever the layout or the loader output changes, stale versions are simply ignored
+const unsigned int OBJ_CACHE_VERSION = 2;
+
+// File the cache was built from, stored in its header
+// The modification time in nanoseconds and the size are 0 when the file did not exist
+struct ObjCacheSource {
+  std::string mtl_name; // MTL file as named by mtllib relative to the MTL base path, empty for the OBJ file
+  long long time;
+  long long size;
+};
+
+// Location of the cache file for a given OBJ file
+std::string GetObjCachePath(const std::string &obj_file);
+
+// Loads OBJ data from the cache if it was built with the same MTL base path and the OBJ file
+// and all MTL files it loaded still have exactly the same modification time and size
+// Otherwise parses the OBJ file and writes the cache for the next run
+// Returns an empty string on success, same as tinyobj::LoadObj
+std::string LoadObjCached(std::vector<tinyobj::shape_t> &shapes,       // [output]
+                          std::vector<tinyobj::material_t> &materials, // [output]
+                          const std::string &obj_file, const char *mtl_basepath = nullptr);
+
+// Reads the cache file of an OBJ file, returns false if it is missing, truncated, has a different version
+// or any of its sources changed
+bool ReadObjCache(std::vector<tinyobj::shape_t> &shapes,       // [output]
+                  std::vector<tinyobj::material_t> &materials, // [output]
+                  const std::string &cache_file, const std::string &obj_file,
+                  const char *mtl_basepath = nullptr);
+
+// Writes a cache file with the sources it was built from, the first one is the OBJ file
+// Returns false if it could not be written
+bool WriteObjCache(const std::vector<tinyobj::shape_t> &shapes,
+                   const std::vector<tinyobj::material_t> &materials,
+                   const std::string &cache_file, const char *mtl_basepath,
+                   const std::vector<ObjCacheSource> &sources);
+
+#endif // PPGSO_OBJ_CACHE_H
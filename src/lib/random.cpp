@@ -0,0 +1,133 @@
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PPGSO_RANDOM_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "random.h"
+
+// Expands the seed into state words, recommended for seeding the xoshiro family
+static uint64_t SplitMix64(uint64_t &x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static inline uint32_t Rotl(uint32_t x, int k) {
+  return (x << k) | (x >> (32 - k));
+}
+
+// One step of xoshiro128**, returns the output for the current state
+static inline uint32_t Step(uint32_t s[4]) {
+  uint32_t result = Rotl(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = Rotl(s[3], 11);
+  return result;
+}
+
+static inline float ToFloat(uint32_t x, float min, float range) {
+  return min + range * ((float) (x >> 8) * (1.0f / 16777216.0f));
+}
+
+Random::Random(uint64_t seed, uint64_t stream) {
+  Seed(seed, stream);
+}
+
+void Random::Seed(uint64_t seed, uint64_t stream) {
+  // Mixing the stream into the seed through SplitMix64 decorrelates neighbouring streams
+  uint64_t x = seed;
+  x ^= SplitMix64(stream);
+  for (int i = 0; i < 4; i += 2) {
+    uint64_t z = SplitMix64(x);
+    state[i] = (uint32_t) z;
+    state[i + 1] = (uint32_t) (z >> 32);
+  }
+  for (int lane = 0; lane < 4; lane++) {
+    for (int k = 0; k < 4; k += 2) {
+      uint64_t z = SplitMix64(x);
+      lanes[k][lane] = (uint32_t) z;
+      lanes[k + 1][lane] = (uint32_t) (z >> 32);
+    }
+  }
+}
+
+uint32_t Random::Next() {
+  return Step(state);
+}
+
+float Random::Float() {
+  return ToFloat(Next(), 0.0f, 1.0f);
+}
+
+float Random::Float(float min, float max) {
+  return ToFloat(Next(), min, max - min);
+}
+
+#ifdef PPGSO_RANDOM_SSE2
+
+static inline __m128i Rotl4(__m128i x, int k) {
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+void Random::Fill(float *out, size_t count, float min, float max) {
+  __m128i s0 = _mm_loadu_si128((const __m128i *) lanes[0]);
+  __m128i s1 = _mm_loadu_si128((const __m128i *) lanes[1]);
+  __m128i s2 = _mm_loadu_si128((const __m128i *) lanes[2]);
+  __m128i s3 = _mm_loadu_si128((const __m128i *) lanes[3]);
+  const __m128 MIN = _mm_set1_ps(min);
+  const __m128 RANGE = _mm_set1_ps(max - min);
+  const __m128 SCALE = _mm_set1_ps(1.0f / 16777216.0f);
+
+  for (size_t i = 0; i < count; i += 4) {
+    // SSE2 has no 32 bit multiply, x * 5 and x * 9 are a shift and an add
+    __m128i x = _mm_add_epi32(s1, _mm_slli_epi32(s1, 2));
+    x = Rotl4(x, 7);
+    x = _mm_add_epi32(x, _mm_slli_epi32(x, 3));
+    __m128i t = _mm_slli_epi32(s1, 9);
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = Rotl4(s3, 11);
+
+    // Same operations as ToFloat
+    __m128 u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), SCALE);
+    __m128 v = _mm_add_ps(MIN, _mm_mul_ps(RANGE, u));
+    if (i + 4 <= count) {
+      _mm_storeu_ps(out + i, v);
+    } else {
+      float last[4];
+      _mm_storeu_ps(last, v);
+      memcpy(out + i, last, (count - i) * sizeof(float));
+    }
+  }
+
+  _mm_storeu_si128((__m128i *) lanes[0], s0);
+  _mm_storeu_si128((__m128i *) lanes[1], s1);
+  _mm_storeu_si128((__m128i *) lanes[2], s2);
+  _mm_storeu_si128((__m128i *) lanes[3], s3);
+}
+
+#else
+
+void Random::Fill(float *out, size_t count, float min, float max) {
+  float range = max - min;
+  for (size_t i = 0; i < count; i += 4) {
+    for (int lane = 0; lane < 4; lane++) {
+      uint32_t s[4] = {lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane]};
+      uint32_t x = Step(s);
+      for (int k = 0; k < 4; k++) lanes[k][lane] = s[k];
+      if (i + lane < count) out[i + lane] = ToFloat(x, min, range);
+    }
+  }
+}
+
+#endif // PPGSO_RANDOM_SSE2
@@ -0,0 +1,34 @@
+#ifndef PPGSO_RANDOM_H
+#define PPGSO_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Small seedable xoshiro128** generator, a replacement for rand() that is fast and reproducible
+// One instance must only be used by one thread at a time, threads or systems own their generators
+// Generators seeded with the same seed but different streams give independent sequences
+class Random {
+public:
+  explicit Random(uint64_t seed = 0, uint64_t stream = 0);
+
+  // Restarts the sequence, the same seed and stream always give the same numbers
+  void Seed(uint64_t seed, uint64_t stream = 0);
+
+  uint32_t Next();
+  // Uniform in [0, 1) with 24 random bits
+  float Float();
+  // Uniform between min and max, min may be larger than max
+  float Float(float min, float max);
+
+  // Fills count floats uniform between min and max for bulk spawns
+  // Four interleaved streams are advanced at once, with SSE2 in one register
+  // The numbers do not depend on SSE2 but differ from count calls of Float
+  void Fill(float *out, size_t count, float min, float max);
+
+private:
+  uint32_t state[4];
+  // Element [k][lane] is word k of the state of each of the four streams used by Fill
+  uint32_t lanes[4][4];
+};
+
+#endif // PPGSO_RANDOM_H
@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+#include "render_queue.h"
+#include "gl_state.h"
+
+// Bits of the resource ids stored in the key, ids beyond that share slots and only batch less well
+const unsigned int KEY_ID_BITS = 10;
+const uint64_t KEY_ID_MASK = (1u << KEY_ID_BITS) - 1;
+
+void RenderQueue::SetViewPosition(const glm::vec3 &position) {
+  viewPosition = position;
+}
+
+void RenderQueue::SetFrustum(const Frustum &frustum) {
+  this->frustum = frustum;
+}
+
+void RenderQueue::Submit(const MeshPtr &mesh, const ShaderPtr &shader, const TexturePtr &texture,
+                         const glm::mat4 &modelMatrix, const glm::vec4 &data, Pass pass) {
+  packets.push_back({mesh.get(), shader.get(), texture.get(), pass, {modelMatrix, data}});
+}
+
+uint64_t RenderQueue::MakeKey(Pass pass, unsigned int shader, unsigned int texture, unsigned int mesh, float depth) {
+  // Bits of a non-negative float compare in the same order as its value
+  uint32_t depth_bits = 0;
+  if (depth > 0.0f) memcpy(&depth_bits, &depth, sizeof(depth_bits));
+
+  uint64_t state = ((shader & KEY_ID_MASK) << (2 * KEY_ID_BITS)) | ((texture & KEY_ID_MASK) << KEY_ID_BITS) |
+                   (mesh & KEY_ID_MASK);
+  if (pass == PASS_OPAQUE)
+    return ((uint64_t) pass << 62) | (state << 32) | depth_bits;
+  return ((uint64_t) pass << 62) | ((uint64_t) (~depth_bits) << 30) | state;
+}
+
+void RenderQueue::RadixSort(std::vector<SortItem> &items, std::vector<SortItem> &temporary) {
+  // Histograms of all eight bytes in a single pass over the keys
+  size_t counts[8][256];
+  memset(counts, 0, sizeof(counts));
+  for (auto &item : items)
+    for (int byte = 0; byte < 8; byte++)
+      counts[byte][(item.key >> (8 * byte)) & 0xFF]++;
+
+  temporary.resize(items.size());
+  for (int byte = 0; byte < 8; byte++) {
+    auto &count = counts[byte];
+    // All keys share this byte, the pass would not change the order
+    if (items.empty() || count[(items[0].key >> (8 * byte)) & 0xFF] == items.size()) continue;
+
+    size_t offsets[256];
+    size_t offset = 0;
+    for (int i = 0; i < 256; i++) {
+      offsets[i] = offset;
+      offset += count[i];
+    }
+    for (auto &item : items)
+      temporary[offsets[(item.key >> (8 * byte)) & 0xFF]++] = item;
+    items.swap(temporary);
+  }
+}
+
+void RenderQueue::draw(const Packet &first, const MeshInstance *instances, size_t count) {
+  auto &state = GLState::Get();
+  bool blended = first.pass == PASS_BLENDED;
+  state.SetDepthTest(!blended);
+  state.SetBlend(blended);
+  if (blended) state.SetBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+  auto sampler = samplers.find(first.shader->GetId());
+  if (sampler == samplers.end())
+    sampler = samplers.emplace(first.shader->GetId(), first.shader->GetUniform<Texture>("Texture")).first;
+
+  first.shader->Use();
+  glUniform1i(sampler->second.location, 0);
+  state.BindTexture(first.texture->GetTexture(), 0);
+  first.mesh->RenderInstanced(instances, count);
+}
+
+RenderQueue::Stats RenderQueue::Execute(bool batching) {
+  auto &state = GLState::Get();
+  size_t issued = state.GetCurrentStats().issued;
+  size_t draws = state.GetCurrentStats().draws;
+
+  // World space bounding spheres, the radius grows with the largest axis scale of the model matrix
+  auto start = std::chrono::steady_clock::now();
+  spheres.Clear();
+  for (auto &packet : packets) {
+    auto &bounds = packet.mesh->GetBounds();
+    auto &model = packet.instance.modelMatrix;
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                           std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    spheres.Add(glm::vec3(model * glm::vec4(bounds.center, 1.0f)), bounds.radius * scale);
+  }
+  visible.resize(packets.size());
+  size_t visible_count = frustum.Cull(spheres, visible.data());
+  auto culled = std::chrono::steady_clock::now();
+
+  // Build keys of the visible packets and sort
+  items.clear();
+  for (size_t i = 0; i < packets.size(); i++) {
+    if (!visible[i]) continue;
+    auto &packet = packets[i];
+    glm::vec3 center{spheres.x[i], spheres.y[i], spheres.z[i]};
+    float depth = glm::distance(center, viewPosition);
+    items.push_back({MakeKey(packet.pass, packet.shader->GetId(), packet.texture->GetId(), packet.mesh->GetId(), depth),
+                     (uint32_t) i});
+  }
+  RadixSort(items, temporary);
+  auto sorted = std::chrono::steady_clock::now();
+
+  // Draw runs of packets sharing all state with one call
+  for (size_t i = 0; i < items.size();) {
+    auto &first = packets[items[i].index];
+    size_t end = i + 1;
+    if (batching) {
+      while (end < items.size()) {
+        auto &next = packets[items[end].index];
+        if (next.pass != first.pass || next.shader != first.shader || next.texture != first.texture ||
+            next.mesh != first.mesh)
+          break;
+        end++;
+      }
+    }
+
+    batch.clear();
+    for (size_t j = i; j < end; j++) batch.push_back(packets[items[j].index].instance);
+    draw(first, batch.data(), batch.size());
+    i = end;
+  }
+
+  // Leave the default state for code drawing outside of the queue
+  state.SetBlend(false);
+  state.SetDepthTest(true);
+
+  stats.packets = packets.size();
+  stats.visible = visible_count;
+  stats.culled = packets.size() - visible_count;
+  stats.draws = state.GetCurrentStats().draws - draws;
+  stats.state_changes = state.GetCurrentStats().issued - issued;
+  stats.cull_time = std::chrono::duration<double>(culled - start).count();
+  stats.sort_time = std::chrono::duration<double>(sorted - culled).count();
+  packets.clear();
+  return stats;
+}
+
+const RenderQueue::Stats &RenderQueue::GetStats() const {
+  return stats;
+}
@@ -0,0 +1,89 @@
+#ifndef PPGSO_RENDER_QUEUE_H
+#define PPGSO_RENDER_QUEUE_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+#include "frustum.h"
+
+// Per-frame list of draws
+// Objects Submit draw packets during Render, Execute culls them, sorts them by a 64bit key and issues the draws
+// Packets are culled with the mesh bounding sphere transformed by the model matrix
+// Key layout, from the most significant bit:
+//   opaque:  pass (2) | shader (10) | texture (10) | mesh (10) | depth (32), drawn front to back within a state
+//   blended: pass (2) | inverted depth (32) | shader (10) | texture (10) | mesh (10), drawn back to front
+// Consecutive packets with the same pass, shader, texture and mesh are merged into one instanced draw
+// Shaders read the packet from "InstanceModelMatrix" and "InstanceData", the texture goes to sampler "Texture"
+class RenderQueue {
+public:
+  // Opaque packets are drawn first, blended packets after them with additive blending and depth test off
+  enum Pass {
+    PASS_OPAQUE = 0,
+    PASS_BLENDED = 1
+  };
+
+  // Work done by one Execute
+  struct Stats {
+    size_t packets;
+    size_t visible;
+    size_t culled;
+    size_t draws;
+    size_t state_changes;   // state changes sent to OpenGL, see GLState
+    double cull_time;       // seconds spent transforming bounds and culling
+    double sort_time;       // seconds spent building keys and sorting
+  };
+
+  // Sort item, index points into the submitted packets
+  struct SortItem {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  // Depth of packets is their distance from this position, set it to the camera position before submitting
+  void SetViewPosition(const glm::vec3 &position);
+  // Packets outside of the frustum are skipped, a default constructed frustum disables culling
+  void SetFrustum(const Frustum &frustum);
+
+  // Resources are referenced without ownership, they have to stay alive until Execute
+  void Submit(const MeshPtr &mesh, const ShaderPtr &shader, const TexturePtr &texture, const glm::mat4 &modelMatrix,
+              const glm::vec4 &data = glm::vec4{1.0f}, Pass pass = PASS_OPAQUE);
+
+  // Sorts and draws all packets submitted since the last call, without batching every packet is a separate draw
+  Stats Execute(bool batching = true);
+  const Stats &GetStats() const;
+
+  static uint64_t MakeKey(Pass pass, unsigned int shader, unsigned int texture, unsigned int mesh, float depth);
+  // Stable LSD radix sort by key, byte passes where all keys are equal are skipped
+  static void RadixSort(std::vector<SortItem> &items, std::vector<SortItem> &temporary);
+
+private:
+  struct Packet {
+    Mesh *mesh;
+    Shader *shader;
+    Texture *texture;
+    Pass pass;
+    MeshInstance instance;
+  };
+
+  void draw(const Packet &first, const MeshInstance *instances, size_t count);
+
+  glm::vec3 viewPosition;
+  Frustum frustum;
+  std::vector<Packet> packets;
+  SphereList spheres;
+  std::vector<uint8_t> visible;
+  std::vector<SortItem> items, temporary;
+  std::vector<MeshInstance> batch;
+  // Sampler handles by shader id, ids are never reused so entries can not go stale
+  std::unordered_map<unsigned int, Shader::Uniform<Texture>> samplers;
+  Stats stats = {0, 0, 0, 0, 0, 0.0, 0.0};
+};
+
+#endif // PPGSO_RENDER_QUEUE_H
@@ -0,0 +1,290 @@
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+#include "resource_cache.h"
+
+ResourceCache &ResourceCache::Get() {
+  static ResourceCache cache;
+  return cache;
+}
+
+uint64_t HashShaderSource(const std::string &vertex_shader_code, const std::string &fragment_shader_code) {
+  uint64_t hash = 14695981039346656037ull;
+  auto add = [&hash](const std::string &code) {
+    for (auto c : code) {
+      hash ^= (uint8_t) c;
+      hash *= 1099511628211ull;
+    }
+    // Separate the sources so moving code from one stage to the other changes the hash
+    hash ^= 0xFF;
+    hash *= 1099511628211ull;
+  };
+  add(vertex_shader_code);
+  add(fragment_shader_code);
+  return hash;
+}
+
+static std::string GetMeshKey(const std::string &obj, VertexFormat format, unsigned int optimize) {
+  std::ostringstream key;
+  key << obj << "|" << (int) format << "|" << optimize;
+  return key.str();
+}
+
+static std::string GetTextureKey(const std::string &raw, unsigned int width, unsigned int height) {
+  std::ostringstream key;
+  key << raw << "|" << width << "x" << height;
+  return key.str();
+}
+
+// Texture keeps its framebuffer next to the GPU copy
+static size_t GetTextureMemory(unsigned int width, unsigned int height) {
+  return 2 * (size_t) width * height * sizeof(Texture::Pixel);
+}
+
+MeshPtr ResourceCache::GetMesh(const std::string &obj, VertexFormat format, unsigned int optimize) {
+  if (!graphics) return nullptr;
+  auto key = GetMeshKey(obj, format, optimize);
+
+  auto it = meshes.entries.find(key);
+  if (it != meshes.entries.end()) {
+    meshes.hits++;
+    it->second.hits++;
+    return it->second.resource;
+  }
+
+  meshes.misses++;
+  auto mesh = MeshPtr(new Mesh{obj, format, optimize});
+  meshes.entries[key] = {mesh, 0, mesh->GetMemorySize()};
+  return mesh;
+}
+
+TexturePtr ResourceCache::GetTexture(const std::string &raw, unsigned int width, unsigned int height) {
+  if (!graphics) return nullptr;
+  auto key = GetTextureKey(raw, width, height);
+
+  auto it = textures.entries.find(key);
+  if (it != textures.entries.end()) {
+    textures.hits++;
+    it->second.hits++;
+    return it->second.resource;
+  }
+
+  textures.misses++;
+  auto texture = TexturePtr(new Texture{raw, width, height});
+  textures.entries[key] = {texture, 0, GetTextureMemory(width, height)};
+  return texture;
+}
+
+MeshPtr ResourceCache::GetMeshAsync(const std::string &obj, VertexFormat format, unsigned int optimize) {
+  if (!graphics) return nullptr;
+  auto key = GetMeshKey(obj, format, optimize);
+
+  auto it = meshes.entries.find(key);
+  if (it != meshes.entries.end()) {
+    meshes.hits++;
+    it->second.hits++;
+    return it->second.resource;
+  }
+
+  meshes.misses++;
+  auto mesh = MeshPtr(new Mesh{});
+  meshes.entries[key] = {mesh, 0, 0};
+
+  // The upload is skipped if the placeholder was evicted in the meantime
+  std::weak_ptr<Mesh> placeholder = mesh;
+  GetLoader().Enqueue([this, placeholder, key, obj, format, optimize]() -> AsyncLoader::UploadFunction {
+    auto data = std::make_shared<Mesh::MeshData>();
+    if (!Mesh::Load(obj, format, optimize, *data)) return nullptr;
+
+    return [this, placeholder, key, data]() -> size_t {
+      auto mesh = placeholder.lock();
+      if (!mesh) return 0;
+      mesh->Upload(*data);
+      auto it = meshes.entries.find(key);
+      if (it != meshes.entries.end()) it->second.memory = mesh->GetMemorySize();
+      return mesh->GetMemorySize();
+    };
+  });
+  return mesh;
+}
+
+TexturePtr ResourceCache::GetTextureAsync(const std::string &raw, unsigned int width, unsigned int height) {
+  if (!graphics) return nullptr;
+  auto key = GetTextureKey(raw, width, height);
+
+  auto it = textures.entries.find(key);
+  if (it != textures.entries.end()) {
+    textures.hits++;
+    it->second.hits++;
+    return it->second.resource;
+  }
+
+  textures.misses++;
+  auto texture = TexturePtr(new Texture{width, height});
+  textures.entries[key] = {texture, 0, GetTextureMemory(width, height)};
+
+  std::weak_ptr<Texture> placeholder = texture;
+  GetLoader().Enqueue([placeholder, raw, width, height]() -> AsyncLoader::UploadFunction {
+    auto pixels = std::make_shared<std::vector<Texture::Pixel>>();
+    if (!Texture::Load(raw, width, height, *pixels)) return nullptr;
+
+    return [placeholder, pixels]() -> size_t {
+      auto texture = placeholder.lock();
+      if (!texture) return 0;
+      size_t bytes = pixels->size() * sizeof(Texture::Pixel);
+      texture->Upload(*pixels);
+      return bytes;
+    };
+  });
+  return texture;
+}
+
+size_t ResourceCache::PreloadManifest(const std::string &manifest) {
+  if (!graphics) return 0;
+  std::ifstream stream(manifest);
+  if (!stream.is_open()) {
+    std::cerr << "Could not open manifest " << manifest << std::endl;
+    return 0;
+  }
+
+  size_t queued = 0;
+  std::string line;
+  for (int line_number = 1; std::getline(stream, line); line_number++) {
+    auto comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+
+    std::istringstream fields(line);
+    std::string type, file;
+    if (!(fields >> type)) continue;
+
+    if (type == "mesh" && fields >> file) {
+      GetMeshAsync(file);
+      queued++;
+      continue;
+    }
+
+    unsigned int width, height;
+    if (type == "texture" && fields >> file >> width >> height) {
+      GetTextureAsync(file, width, height);
+      queued++;
+      continue;
+    }
+
+    std::cerr << manifest << ":" << line_number << ": invalid manifest entry " << line << std::endl;
+  }
+  return queued;
+}
+
+AsyncLoader::FrameStats ResourceCache::ProcessUploads(double budget_seconds) {
+  if (!loader) return upload_stats = {0, 0, 0.0, 0};
+  return upload_stats = loader->ProcessUploads(budget_seconds);
+}
+
+AsyncLoader::FrameStats ResourceCache::FinishLoading() {
+  if (!loader) return upload_stats = {0, 0, 0.0, 0};
+  return upload_stats = loader->Finish();
+}
+
+const AsyncLoader::FrameStats &ResourceCache::GetUploadStats() const {
+  return upload_stats;
+}
+
+AsyncLoader &ResourceCache::GetLoader() {
+  if (!loader) loader.reset(new AsyncLoader{});
+  return *loader;
+}
+
+ShaderPtr ResourceCache::GetShader(const std::string &vertex_shader_code, const std::string &fragment_shader_code) {
+  if (!graphics) return nullptr;
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << HashShaderSource(vertex_shader_code, fragment_shader_code);
+
+  auto it = shaders.entries.find(key.str());
+  if (it != shaders.entries.end()) {
+    shaders.hits++;
+    it->second.hits++;
+    return it->second.resource;
+  }
+
+  shaders.misses++;
+  auto shader = ShaderPtr(new Shader{vertex_shader_code, fragment_shader_code});
+  shaders.entries[key.str()] = {shader, 0, vertex_shader_code.size() + fragment_shader_code.size()};
+  return shader;
+}
+
+template<typename T>
+size_t ResourceCache::Registry<T>::EvictUnused() {
+  size_t evicted = 0;
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.resource.use_count() == 1) {
+      it = entries.erase(it);
+      evicted++;
+    } else {
+      ++it;
+    }
+  }
+  evictions += evicted;
+  return evicted;
+}
+
+template<typename T>
+ResourceCache::Stats ResourceCache::Registry<T>::GetStats() const {
+  Stats stats = {hits, misses, evictions, entries.size(), 0};
+  for (auto &entry : entries) stats.memory += entry.second.memory;
+  return stats;
+}
+
+template<typename T>
+void ResourceCache::Registry<T>::Print(std::ostream &stream, const char *type) const {
+  auto stats = GetStats();
+  stream << type << ": " << stats.entries << " entries, " << stats.hits << " hits, " << stats.misses << " misses, "
+         << stats.evictions << " evictions, " << stats.memory / 1024 << " kB" << std::endl;
+  for (auto &entry : entries) {
+    stream << "  " << std::left << std::setw(40) << entry.first << std::right
+           << std::setw(6) << entry.second.hits << " hits "
+           << std::setw(8) << entry.second.memory / 1024 << " kB "
+           << std::setw(4) << entry.second.resource.use_count() - 1 << " users" << std::endl;
+  }
+}
+
+void ResourceCache::DisableGraphics() {
+  graphics = false;
+}
+
+bool ResourceCache::IsGraphicsEnabled() const {
+  return graphics;
+}
+
+size_t ResourceCache::EvictUnused() {
+  // Meshes may hold their shader and texture, release them first so those become unused too
+  return meshes.EvictUnused() + textures.EvictUnused() + shaders.EvictUnused();
+}
+
+void ResourceCache::Clear() {
+  meshes.evictions += meshes.entries.size();
+  textures.evictions += textures.entries.size();
+  shaders.evictions += shaders.entries.size();
+  meshes.entries.clear();
+  textures.entries.clear();
+  shaders.entries.clear();
+}
+
+ResourceCache::Stats ResourceCache::GetMeshStats() const {
+  return meshes.GetStats();
+}
+
+ResourceCache::Stats ResourceCache::GetTextureStats() const {
+  return textures.GetStats();
+}
+
+ResourceCache::Stats ResourceCache::GetShaderStats() const {
+  return shaders.GetStats();
+}
+
+void ResourceCache::PrintStats(std::ostream &stream) const {
+  meshes.Print(stream, "Meshes");
+  textures.Print(stream, "Textures");
+  shaders.Print(stream, "Shaders");
+}
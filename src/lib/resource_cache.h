@@ -0,0 +1,108 @@
+#ifndef PPGSO_RESOURCE_CACHE_H
+#define PPGSO_RESOURCE_CACHE_H
+
+#include <string>
+#include <map>
+#include <ostream>
+#include <cstdint>
+#include <memory>
+
+#include "async_loader.h"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+
+// Shared registry of meshes, textures and shaders
+// Meshes and textures are keyed by file path and load parameters, shaders by a hash of their source code
+// Identical requests from different classes return the same object, so each asset is loaded and uploaded once
+// The cache keeps a reference to every resource until it is evicted, EvictUnused releases the ones nobody else holds
+// Async getters return an empty placeholder at once and load the data in the background, see AsyncLoader
+// All methods must be called from the thread owning the OpenGL context
+class ResourceCache {
+public:
+  // Hit, miss and memory statistics of one resource type
+  struct Stats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    size_t memory;
+  };
+
+  // Cache used by all scenes of the application
+  static ResourceCache &Get();
+
+  MeshPtr GetMesh(const std::string &obj, VertexFormat format = VertexFormat::Float,
+                  unsigned int optimize = OPTIMIZE_DEFAULT);
+  TexturePtr GetTexture(const std::string &raw, unsigned int width, unsigned int height);
+  ShaderPtr GetShader(const std::string &vertex_shader_code, const std::string &fragment_shader_code);
+
+  // Same as above, but files are read and parsed on worker threads
+  // The returned mesh draws nothing and the texture is black until ProcessUploads uploads the loaded data
+  // Synchronous getters for a resource that is still loading also return the placeholder
+  MeshPtr GetMeshAsync(const std::string &obj, VertexFormat format = VertexFormat::Float,
+                       unsigned int optimize = OPTIMIZE_DEFAULT);
+  TexturePtr GetTextureAsync(const std::string &raw, unsigned int width, unsigned int height);
+
+  // Starts loading every resource listed in a manifest file, returns the number of queued resources
+  // Each line is either "mesh <file.obj>" or "texture <file.rgb> <width> <height>", "#" starts a comment
+  size_t PreloadManifest(const std::string &manifest);
+  // Uploads loaded resources to the GPU, call once per frame with the time in seconds it may take
+  AsyncLoader::FrameStats ProcessUploads(double budget_seconds);
+  // Blocks until all queued resources are loaded and uploaded
+  AsyncLoader::FrameStats FinishLoading();
+  // Stats of the last ProcessUploads call
+  const AsyncLoader::FrameStats &GetUploadStats() const;
+
+  // For runs without an OpenGL context, afterwards all getters return nullptr and nothing is loaded or cached
+  void DisableGraphics();
+  bool IsGraphicsEnabled() const;
+
+  // Releases resources that are only referenced by the cache, returns the number of released entries
+  size_t EvictUnused();
+  // Releases all resources, objects still holding them keep them alive
+  void Clear();
+
+  Stats GetMeshStats() const;
+  Stats GetTextureStats() const;
+  Stats GetShaderStats() const;
+
+  // Prints hit/miss counts and memory of every cached resource
+  void PrintStats(std::ostream &stream) const;
+
+private:
+  template<typename T>
+  struct Entry {
+    std::shared_ptr<T> resource;
+    size_t hits;
+    size_t memory;
+  };
+
+  template<typename T>
+  struct Registry {
+    std::map<std::string, Entry<T>> entries;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    size_t EvictUnused();
+    Stats GetStats() const;
+    void Print(std::ostream &stream, const char *type) const;
+  };
+
+  AsyncLoader &GetLoader();
+
+  Registry<Mesh> meshes;
+  Registry<Texture> textures;
+  Registry<Shader> shaders;
+
+  // Created on the first asynchronous request so synchronous users never start threads
+  std::unique_ptr<AsyncLoader> loader;
+  AsyncLoader::FrameStats upload_stats = {0, 0, 0.0, 0};
+  bool graphics = true;
+};
+
+// 64bit FNV-1a hash of shader source code, used as the shader cache key
+uint64_t HashShaderSource(const std::string &vertex_shader_code, const std::string &fragment_shader_code);
+
+#endif // PPGSO_RESOURCE_CACHE_H
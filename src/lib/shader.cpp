@@ -1,10 +1,12 @@
 #include <iostream>
+#include <algorithm>
 
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "texture.h"
 #include "shader.h"
+#include "gl_state.h"
 
 Shader::Shader(const std::string &vertex_shader_code, const std::string &fragment_shader_code) {
   // Create shaders
@@ -50,6 +52,11 @@ Shader::Shader(const std::string &vertex_shader_code, const std::string &fragmen
   glAttachShader(program_id, vertex_shader_id);
   glAttachShader(program_id, fragment_shader_id);
   glBindFragDataLocation(program_id, 0, "FragmentColor");
+  glBindAttribLocation(program_id, ATTRIBUTE_POSITION, "Position");
+  glBindAttribLocation(program_id, ATTRIBUTE_TEXCOORD, "TexCoord");
+  glBindAttribLocation(program_id, ATTRIBUTE_NORMAL, "Normal");
+  glBindAttribLocation(program_id, ATTRIBUTE_INSTANCE_MODEL, "InstanceModelMatrix");
+  glBindAttribLocation(program_id, ATTRIBUTE_INSTANCE_DATA, "InstanceData");
   glLinkProgram(program_id);
 
   // Check program log
@@ -64,61 +71,167 @@ Shader::Shader(const std::string &vertex_shader_code, const std::string &fragmen
   glDeleteShader(vertex_shader_id);
   glDeleteShader(fragment_shader_id);
 
+  // Connect shared uniform blocks to their fixed binding points
+  auto camera_block = glGetUniformBlockIndex(program_id, "Camera");
+  if (camera_block != GL_INVALID_INDEX) glUniformBlockBinding(program_id, camera_block, UNIFORM_BLOCK_CAMERA);
+
   program = program_id;
+  static unsigned int next_id = 0;
+  id = next_id++;
+  reflect();
+}
+
+void Shader::reflect() {
+  GLint count = 0, max_length = 0;
+  GLint length = 0;
+
+  // Uniforms, arrays are reported as "name[0]" and are also registered without the suffix
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+  std::string name((size_t) std::max(max_length, 1), ' ');
+  for (GLint i = 0; i < count; i++) {
+    Variable variable;
+    glGetActiveUniform(program, (GLuint) i, (GLsizei) name.size(), &length, &variable.size, &variable.type, &name[0]);
+    std::string uniform_name(name.data(), (size_t) length);
+    variable.location = glGetUniformLocation(program, uniform_name.c_str());
+    // Members of uniform blocks have no location
+    if (variable.location < 0) continue;
+    uniforms[uniform_name] = variable;
+    auto array = uniform_name.find("[0]");
+    if (array != std::string::npos) uniforms[uniform_name.substr(0, array)] = variable;
+  }
+
+  // Attributes
+  glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+  glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+  name.assign((size_t) std::max(max_length, 1), ' ');
+  for (GLint i = 0; i < count; i++) {
+    Variable variable;
+    glGetActiveAttrib(program, (GLuint) i, (GLsizei) name.size(), &length, &variable.size, &variable.type, &name[0]);
+    std::string attrib_name(name.data(), (size_t) length);
+    variable.location = glGetAttribLocation(program, attrib_name.c_str());
+    attribs[attrib_name] = variable;
+  }
+}
+
+GLint Shader::findUniform(const std::string &name, GLenum type) const {
+  auto variable = FindUniform(name);
+  if (!variable) return -1;
+  if (variable->type != type) {
+    std::cerr << "Uniform " << name << " is declared with a different type in the shader!" << std::endl;
+    return -1;
+  }
+  return variable->location;
+}
+
+const Shader::Variable *Shader::FindUniform(const std::string &name) const {
+  auto it = uniforms.find(name);
+  return it != uniforms.end() ? &it->second : nullptr;
+}
+
+const Shader::Variable *Shader::FindAttrib(const std::string &name) const {
+  auto it = attribs.find(name);
+  return it != attribs.end() ? &it->second : nullptr;
+}
+
+const std::unordered_map<std::string, Shader::Variable> &Shader::GetUniforms() const {
+  return uniforms;
+}
+
+const std::unordered_map<std::string, Shader::Variable> &Shader::GetAttribs() const {
+  return attribs;
 }
 
 Shader::~Shader() {
+  GLState::Get().ForgetProgram(program);
   glDeleteProgram( program );
 }
 
 void Shader::Use() {
-  glUseProgram(program);
+  GLState::Get().UseProgram(program);
 }
 
+// Inactive variables map to -1, same as the glGet*Location functions return
 GLuint Shader::GetAttribLocation(const std::string &name) {
-  return glGetAttribLocation(program, name.c_str());
+  auto variable = FindAttrib(name);
+  return variable ? (GLuint) variable->location : (GLuint) -1;
 }
 
 GLuint Shader::GetUniformLocation(const std::string &name) {
-  return glGetUniformLocation(program, name.c_str());
+  auto variable = FindUniform(name);
+  return variable ? (GLuint) variable->location : (GLuint) -1;
 }
 
 void Shader::SetTexture(const TexturePtr texture, const std::string &name) {
   auto texture_id = texture->GetTexture();
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniform1i(uniform, 0);
-  glActiveTexture(GL_TEXTURE0 + 0);
-  glBindTexture(GL_TEXTURE_2D, texture_id);
+  GLState::Get().BindTexture(texture_id, 0);
 }
 
 void Shader::SetMatrix(glm::mat4 matrix, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniformMatrix4fv(uniform, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::SetMatrix(glm::mat3 matrix, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniformMatrix3fv(uniform, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::SetFloat(float value, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniform1f(uniform, value);
 }
 
 GLuint Shader::GetProgram() { return program; }
 
+unsigned int Shader::GetId() const { return id; }
+
 void Shader::SetVector(glm::vec2 vector, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniform2fv(uniform, 1, glm::value_ptr(vector));
 }
 
 void Shader::SetVector(glm::vec3 vector, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniform3fv(uniform, 1, glm::value_ptr(vector));
 }
 
 void Shader::SetVector(glm::vec4 vector, const std::string &name) {
-  auto uniform = GetUniformLocation(name.c_str());
+  auto uniform = GetUniformLocation(name);
   glUniform4fv(uniform, 1, glm::value_ptr(vector));
 }
+
+void Shader::Set(Uniform<GLint> uniform, GLint value) {
+  glUniform1i(uniform.location, value);
+}
+
+void Shader::Set(Uniform<GLfloat> uniform, GLfloat value) {
+  glUniform1f(uniform.location, value);
+}
+
+void Shader::Set(Uniform<glm::vec2> uniform, const glm::vec2 &vector) {
+  glUniform2fv(uniform.location, 1, glm::value_ptr(vector));
+}
+
+void Shader::Set(Uniform<glm::vec3> uniform, const glm::vec3 &vector) {
+  glUniform3fv(uniform.location, 1, glm::value_ptr(vector));
+}
+
+void Shader::Set(Uniform<glm::vec4> uniform, const glm::vec4 &vector) {
+  glUniform4fv(uniform.location, 1, glm::value_ptr(vector));
+}
+
+void Shader::Set(Uniform<glm::mat3> uniform, const glm::mat3 &matrix) {
+  glUniformMatrix3fv(uniform.location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::Set(Uniform<glm::mat4> uniform, const glm::mat4 &matrix) {
+  glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::Set(Uniform<Texture> uniform, const TexturePtr &texture, GLint unit) {
+  glUniform1i(uniform.location, unit);
+  GLState::Get().BindTexture(texture->GetTexture(), (GLuint) unit);
+}
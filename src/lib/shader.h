@@ -3,14 +3,60 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 #include <GL/glew.h>
 #include <glm/mat4x4.hpp>
 
 #include "texture.h"
 
+// Vertex attribute locations bound in every program before linking
+// Meshes use these locations, so one mesh can be rendered with any shader
+enum ShaderAttribute {
+  ATTRIBUTE_POSITION = 0,
+  ATTRIBUTE_TEXCOORD = 1,
+  ATTRIBUTE_NORMAL = 2,
+  // Per-instance attributes of instanced draws, the model matrix takes four consecutive locations
+  ATTRIBUTE_INSTANCE_MODEL = 3,
+  ATTRIBUTE_INSTANCE_DATA = 7
+};
+
+// Uniform buffer binding points, blocks with these names are bound in every program after linking
+// Data shared by all programs is uploaded once per frame to a UniformBuffer bound to the same point
+enum UniformBlockBinding {
+  UNIFORM_BLOCK_CAMERA = 0   // uniform block "Camera"
+};
+
+// OpenGL type of a uniform declared in GLSL, used to check typed uniform handles
+template<typename T> struct UniformType;
+template<> struct UniformType<GLint> { static const GLenum type = GL_INT; };
+template<> struct UniformType<GLfloat> { static const GLenum type = GL_FLOAT; };
+template<> struct UniformType<glm::vec2> { static const GLenum type = GL_FLOAT_VEC2; };
+template<> struct UniformType<glm::vec3> { static const GLenum type = GL_FLOAT_VEC3; };
+template<> struct UniformType<glm::vec4> { static const GLenum type = GL_FLOAT_VEC4; };
+template<> struct UniformType<glm::mat3> { static const GLenum type = GL_FLOAT_MAT3; };
+template<> struct UniformType<glm::mat4> { static const GLenum type = GL_FLOAT_MAT4; };
+template<> struct UniformType<Texture> { static const GLenum type = GL_SAMPLER_2D; };
+
+// Linked GLSL program
+// Active uniforms and attributes are reflected into a hash table after linking, so no lookup asks the driver
+// For per-frame updates resolve a typed Uniform handle once and keep it, setting it involves no string at all
 class Shader {
 public:
+  // Reflected uniform or attribute
+  struct Variable {
+    GLint location;
+    GLenum type;
+    GLint size;   // array length, 1 for plain variables
+  };
+
+  // Pre-resolved uniform location, location is -1 for uniforms not used by the program
+  // Setting a -1 location is ignored by OpenGL, same as for glGetUniformLocation
+  template<typename T>
+  struct Uniform {
+    GLint location = -1;
+  };
+
   Shader(const std::string &vertex_shader_code, const std::string &fragment_shader_code);
 
   ~Shader();
@@ -22,6 +68,8 @@ public:
   GLuint GetUniformLocation(const std::string &name);
 
   GLuint GetProgram();
+  // Unique number of the shader in this process, used to sort draws by program
+  unsigned int GetId() const;
 
   void SetFloat(float value, const std::string &name);
   void SetVector(glm::vec2 vector, const std::string &name);
@@ -30,8 +78,40 @@ public:
   void SetTexture(const TexturePtr texture, const std::string &name);
   void SetMatrix(glm::mat4 matrix, const std::string &name);
   void SetMatrix(glm::mat3 matrix, const std::string &name);
+
+  // Resolves a uniform handle, reports a type mismatch between T and the GLSL declaration
+  template<typename T>
+  Uniform<T> GetUniform(const std::string &name) const {
+    Uniform<T> uniform;
+    uniform.location = findUniform(name, UniformType<T>::type);
+    return uniform;
+  }
+
+  // Set uniforms of the program in use through handles
+  void Set(Uniform<GLint> uniform, GLint value);
+  void Set(Uniform<GLfloat> uniform, GLfloat value);
+  void Set(Uniform<glm::vec2> uniform, const glm::vec2 &vector);
+  void Set(Uniform<glm::vec3> uniform, const glm::vec3 &vector);
+  void Set(Uniform<glm::vec4> uniform, const glm::vec4 &vector);
+  void Set(Uniform<glm::mat3> uniform, const glm::mat3 &matrix);
+  void Set(Uniform<glm::mat4> uniform, const glm::mat4 &matrix);
+  // Binds the texture to the given texture unit and points the sampler to it
+  void Set(Uniform<Texture> uniform, const TexturePtr &texture, GLint unit = 0);
+
+  // Reflection data, nullptr if the program has no such active variable
+  const Variable *FindUniform(const std::string &name) const;
+  const Variable *FindAttrib(const std::string &name) const;
+  const std::unordered_map<std::string, Variable> &GetUniforms() const;
+  const std::unordered_map<std::string, Variable> &GetAttribs() const;
+
 private:
+  void reflect();
+  GLint findUniform(const std::string &name, GLenum type) const;
+
   GLuint program;
+  unsigned int id;
+  std::unordered_map<std::string, Variable> uniforms;
+  std::unordered_map<std::string, Variable> attribs;
 };
 typedef std::shared_ptr< Shader > ShaderPtr;
 
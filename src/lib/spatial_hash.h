@@ -0,0 +1,156 @@
+#ifndef PPGSO_SPATIAL_HASH_H
+#define PPGSO_SPATIAL_HASH_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/vec3.hpp>
+
+// Broad phase for proximity queries on a uniform grid of cubic cells
+// Entries are inserted with a layer, a position and a radius, then Build sorts them into hashed cell buckets
+// Query visits only the entries of one layer in the cells around a sphere, callers do the exact test themselves
+// The grid is meant to be rebuilt every frame, Remove hides entries that disappear before the next rebuild
+// Cells about twice the typical query distance keep the number of visited cells small
+template<typename T>
+class SpatialHash {
+public:
+  SpatialHash(float cellSize = 1.0f, unsigned int layers = 1) : cellSize(cellSize), maxRadius(layers, 0.0f), mask(0) {
+  }
+
+  void SetCellSize(float cellSize) {
+    this->cellSize = cellSize;
+  }
+
+  float GetCellSize() const {
+    return cellSize;
+  }
+
+  // Removes all entries, the next Insert gets id 0
+  void Clear() {
+    entries.clear();
+    removed.clear();
+    order.clear();
+    starts.clear();
+    std::fill(maxRadius.begin(), maxRadius.end(), 0.0f);
+  }
+
+  // Ids are given out in insertion order, entries inserted after Build are not found until the next Build
+  size_t Insert(unsigned int layer, const glm::vec3 &position, float radius, const T &value) {
+    if (layer >= maxRadius.size()) maxRadius.resize(layer + 1, 0.0f);
+    maxRadius[layer] = std::max(maxRadius[layer], radius);
+    entries.push_back({position, layer, {0, 0, 0}, value});
+    removed.push_back(0);
+    return entries.size() - 1;
+  }
+
+  // Entry is skipped by queries until the next Clear
+  void Remove(size_t id) {
+    if (id < removed.size()) removed[id] = 1;
+  }
+
+  bool IsRemoved(size_t id) const {
+    return id < removed.size() && removed[id];
+  }
+
+  // Counting sort of the entries by bucket, twice as many buckets as entries keep the chains short
+  void Build() {
+    size_t buckets = 16;
+    while (buckets < entries.size() * 2) buckets *= 2;
+    mask = (uint32_t) (buckets - 1);
+
+    starts.assign(buckets + 1, 0);
+    std::vector<uint32_t> hashes(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+      auto &entry = entries[i];
+      for (int axis = 0; axis < 3; axis++) entry.cell[axis] = getCell(entry.position[axis]);
+      hashes[i] = hash(entry.cell[0], entry.cell[1], entry.cell[2], entry.layer);
+      starts[hashes[i] + 1]++;
+    }
+    for (size_t i = 0; i < buckets; i++) starts[i + 1] += starts[i];
+
+    order.resize(entries.size());
+    std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < entries.size(); i++) order[next[hashes[i]]++] = (uint32_t) i;
+  }
+
+  // Calls function(value) for every entry of the layer that can be within radius plus its own radius of center
+  // Positions are the ones passed to Insert, callers test against current positions
+  template<typename Function>
+  void Query(unsigned int layer, const glm::vec3 &center, float radius, Function function) const {
+    if (layer >= maxRadius.size() || order.empty()) return;
+    float range = radius + maxRadius[layer];
+
+    int low[3], high[3];
+    size_t cells = 1;
+    for (int axis = 0; axis < 3; axis++) {
+      low[axis] = getCell(center[axis] - range);
+      high[axis] = getCell(center[axis] + range);
+      cells *= (size_t) (high[axis] - low[axis] + 1);
+    }
+
+    // Visiting more cells than there are entries is slower than checking every entry
+    if (cells > order.size()) {
+      for (auto id : order) {
+        auto &entry = entries[id];
+        if (entry.layer != layer || removed[id] || !inside(entry, low, high)) continue;
+        function(entry.value);
+      }
+      return;
+    }
+
+    for (int x = low[0]; x <= high[0]; x++) {
+      for (int y = low[1]; y <= high[1]; y++) {
+        for (int z = low[2]; z <= high[2]; z++) {
+          uint32_t bucket = hash(x, y, z, layer);
+          for (uint32_t i = starts[bucket]; i < starts[bucket + 1]; i++) {
+            auto &entry = entries[order[i]];
+            // Other cells and layers may share the bucket
+            if (entry.layer != layer || entry.cell[0] != x || entry.cell[1] != y || entry.cell[2] != z) continue;
+            if (removed[order[i]]) continue;
+            function(entry.value);
+          }
+        }
+      }
+    }
+  }
+
+  size_t Size() const {
+    return entries.size();
+  }
+
+private:
+  struct Entry {
+    glm::vec3 position;
+    unsigned int layer;
+    int cell[3];
+    T value;
+  };
+
+  int getCell(float coordinate) const {
+    return (int) std::floor(coordinate / cellSize);
+  }
+
+  uint32_t hash(int x, int y, int z, unsigned int layer) const {
+    return ((uint32_t) x * 73856093u ^ (uint32_t) y * 19349663u ^ (uint32_t) z * 83492791u ^
+            (uint32_t) layer * 2654435761u) & mask;
+  }
+
+  static bool inside(const Entry &entry, const int *low, const int *high) {
+    for (int axis = 0; axis < 3; axis++)
+      if (entry.cell[axis] < low[axis] || entry.cell[axis] > high[axis]) return false;
+    return true;
+  }
+
+  float cellSize;
+  std::vector<Entry> entries;     // in insertion order, index is the id
+  std::vector<uint8_t> removed;
+  std::vector<uint32_t> order;    // entry ids sorted by bucket
+  std::vector<uint32_t> starts;   // first position in order of every bucket, one extra at the end
+  std::vector<float> maxRadius;   // largest radius inserted into each layer
+  uint32_t mask;
+};
+
+#endif // PPGSO_SPATIAL_HASH_H
@@ -2,37 +2,53 @@
 #include <fstream>
 
 #include "texture.h"
+#include "gl_state.h"
 
 Texture::Texture(unsigned int width, unsigned int height) : width(width), height(height) {
-  framebuffer.reserve(width * height);
+  framebuffer.resize(width * height);
   initGL();
   Update();
 }
 
 Texture::Texture(const std::string &raw, unsigned int width, unsigned int height) : width(width), height(height) {
-  framebuffer.reserve(width * height * sizeof(Pixel));
+  Load(raw, width, height, framebuffer);
+  initGL();
+  Update();
+}
+
+bool Texture::Load(const std::string &raw, unsigned int width, unsigned int height, std::vector<Pixel> &pixels) {
+  pixels.assign(width * height, Pixel{0, 0, 0});
 
   // Open file stream
   std::ifstream image_stream(raw, std::ios::binary);
 
-  if (!image_stream.is_open())
+  if (!image_stream.is_open()) {
     std::cerr << "Could not open texture " << raw << std::endl;
+    return false;
+  }
 
-  // Load the
-  image_stream.read((char *)framebuffer.data(), framebuffer.capacity()*sizeof(Pixel));
+  // Load the raw pixels
+  image_stream.read((char *) pixels.data(), pixels.size() * sizeof(Pixel));
   image_stream.close();
-  initGL();
+  return true;
+}
+
+void Texture::Upload(std::vector<Pixel> &pixels) {
+  framebuffer.swap(pixels);
   Update();
 }
 
 Texture::~Texture() {
+  GLState::Get().ForgetTexture(texture);
   glDeleteTextures(1, &texture);
 }
 
 void Texture::initGL() {
   // Create new texture object
+  static unsigned int next_id = 0;
+  id = next_id++;
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  GLState::Get().BindTexture(texture);
 
   // Set mipmaps
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -47,7 +63,11 @@ void Texture::Update() {
 }
 
 void Texture::Use() {
-  glBindTexture(GL_TEXTURE_2D, texture);
+  GLState::Get().BindTexture(texture);
+}
+
+unsigned int Texture::GetId() const {
+  return id;
 }
 
 GLuint Texture::GetTexture() {
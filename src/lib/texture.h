@@ -16,17 +16,26 @@ public:
   Texture(const std::string &raw, unsigned int width, unsigned int height);
   ~Texture();
 
+  // Reads a raw RGB file into pixels without touching OpenGL, safe to call from any thread
+  // Returns false if the file could not be opened, pixels are then left black
+  static bool Load(const std::string &raw, unsigned int width, unsigned int height, std::vector<Pixel> &pixels);
+  // Replaces the framebuffer with loaded pixels and uploads it
+  void Upload(std::vector<Pixel> &pixels);
+
   void Update();
   Pixel* GetFramebuffer();
   GLuint GetTexture();
   Pixel* GetPixel(int x, int y);
   void Use();
+  // Unique number of the texture in this process, used to sort draws by texture
+  unsigned int GetId() const;
 
   unsigned int width, height;
 private:
   void initGL();
   std::vector<Pixel> framebuffer;
   GLuint texture;
+  unsigned int id;
 };
 typedef std::shared_ptr< Texture > TexturePtr;
 
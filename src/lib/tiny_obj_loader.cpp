@@ -40,8 +40,12 @@
 #include <map>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "tiny_obj_loader.h"
+#include "mapped_file.h"
 
 namespace tinyobj {
 
@@ -54,7 +58,7 @@ struct vertex_index {
   vertex_index(int vidx, int vtidx, int vnidx)
       : v_idx(vidx), vt_idx(vtidx), vn_idx(vnidx){};
 };
-// for std::map
+// for std::map, see TINY_OBJ_LOADER_MAP_VERTEX_CACHE
 static inline bool operator<(const vertex_index &a, const vertex_index &b) {
   if (a.v_idx != b.v_idx)
     return (a.v_idx < b.v_idx);
@@ -72,6 +76,44 @@ struct obj_shape {
   std::vector<float> vt;
 };
 
+// Faces of a group stored back to back in a single array.
+// face_sizes holds the number of vertices of each face, so parsing a face
+// does not allocate once the group has grown to its working size.
+struct face_group {
+  std::vector<vertex_index> vertices;
+  std::vector<unsigned int> face_sizes;
+
+  bool empty() const { return face_sizes.empty(); }
+  void clear() {
+    vertices.clear();
+    face_sizes.clear();
+  }
+};
+
+// Consecutive faces of a face group, used without copying them.
+// The face group must outlive the range.
+struct face_range {
+  const vertex_index *vertices;
+  const unsigned int *face_sizes;
+  size_t faces;
+  size_t vertexCount;
+
+  explicit face_range(const face_group &group)
+      : vertices(group.vertices.data()), face_sizes(group.face_sizes.data()),
+        faces(group.face_sizes.size()), vertexCount(group.vertices.size()) {}
+
+  // Faces [first, last), their vertices are [firstVertex, lastVertex).
+  face_range slice(size_t first, size_t last, size_t firstVertex,
+                   size_t lastVertex) const {
+    face_range range(*this);
+    range.vertices += firstVertex;
+    range.face_sizes += first;
+    range.faces = last - first;
+    range.vertexCount = lastVertex - firstVertex;
+    return range;
+  }
+};
+
 static inline bool isSpace(const char c) { return (c == ' ') || (c == '\t'); }
 
 static inline bool isNewLine(const char c) {
@@ -295,18 +337,120 @@ static vertex_index parseTriple(const char *&token, int vsize, int vnsize,
   return vi;
 }
 
+#ifdef TINY_OBJ_LOADER_MAP_VERTEX_CACHE
+// Ordered map vertex cache, kept for comparison with the hash table.
+struct vertex_cache {
+  std::map<vertex_index, unsigned int> map;
+
+  void reset(size_t) { map.clear(); }
+
+  // Returns the cached index of i or inserts idx and returns it.
+  unsigned int insert(const vertex_index &i, unsigned int idx, bool &found) {
+    std::pair<std::map<vertex_index, unsigned int>::iterator, bool> it =
+        map.insert(std::make_pair(i, idx));
+    found = !it.second;
+    return it.first->second;
+  }
+};
+#else
+// Open addressing hash table of deduplicated vertices.
+// The table is sized from the number of face vertices of a group and the
+// number of positions, which is enough for most meshes, and only grows for
+// meshes that split many positions by normals or texture coordinates.
+// Only the part used by the current shape is cleared, so reusing a large
+// table for many small shapes stays cheap.
+struct vertex_cache {
+  static const unsigned int EMPTY = 0xFFFFFFFFu;
+
+  struct slot {
+    vertex_index key;
+    unsigned int value;
+  };
+
+  std::vector<slot> slots;
+  size_t mask;
+  size_t count;
+
+  vertex_cache() : mask(0), count(0) {}
+
+  // Empties the cache and makes room for about count vertices.
+  void reset(size_t expected) {
+    // Keep the load factor at or below 1/2
+    size_t size = 16;
+    while (size < 2 * expected)
+      size *= 2;
+
+    slot empty;
+    empty.key = vertex_index(-1);
+    empty.value = EMPTY;
+    if (size > slots.size())
+      slots.resize(size);
+    std::fill(slots.begin(), slots.begin() + size, empty);
+    mask = size - 1;
+    count = 0;
+  }
+
+  static inline size_t hash(const vertex_index &i) {
+    unsigned int h = static_cast<unsigned int>(i.v_idx) * 0x9E3779B1u;
+    h ^= static_cast<unsigned int>(i.vn_idx) * 0x85EBCA77u;
+    h ^= static_cast<unsigned int>(i.vt_idx) * 0xC2B2AE3Du;
+    return h ^ (h >> 15);
+  }
+
+  // Doubles the table and inserts all entries again.
+  void grow() {
+    std::vector<slot> entries;
+    entries.reserve(count);
+    for (size_t n = 0; n <= mask; n++)
+      if (slots[n].value != EMPTY)
+        entries.push_back(slots[n]);
+
+    reset(mask + 1);
+    for (size_t e = 0; e < entries.size(); e++) {
+      size_t n = hash(entries[e].key);
+      while (slots[n & mask].value != EMPTY)
+        n++;
+      slots[n & mask] = entries[e];
+    }
+    count = entries.size();
+  }
+
+  // Returns the cached index of i or inserts idx and returns it.
+  unsigned int insert(const vertex_index &i, unsigned int idx, bool &found) {
+    for (size_t n = hash(i);; n++) {
+      slot &s = slots[n & mask];
+      if (s.value == EMPTY) {
+        s.key = i;
+        s.value = idx;
+        found = false;
+        if (2 * ++count > mask + 1)
+          grow();
+        return idx;
+      }
+      if (s.key.v_idx == i.v_idx && s.key.vn_idx == i.vn_idx &&
+          s.key.vt_idx == i.vt_idx) {
+        found = true;
+        return s.value;
+      }
+    }
+  }
+};
+#endif
+
 static unsigned int
-updateVertex(std::map<vertex_index, unsigned int> &vertexCache,
+updateVertex(vertex_cache &vertexCache,
              std::vector<float> &positions, std::vector<float> &normals,
              std::vector<float> &texcoords,
              const std::vector<float> &in_positions,
              const std::vector<float> &in_normals,
              const std::vector<float> &in_texcoords, const vertex_index &i) {
-  const std::map<vertex_index, unsigned int>::iterator it = vertexCache.find(i);
+  bool found;
+  unsigned int idx = vertexCache.insert(
+      i, static_cast<unsigned int>(positions.size() / 3), found);
 
-  if (it != vertexCache.end()) {
+  if (found) {
     // found cache
-    return it->second;
+    return idx;
   }
 
   assert(in_positions.size() > (unsigned int)(3 * i.v_idx + 2));
@@ -326,9 +470,6 @@ updateVertex(std::map<vertex_index, unsigned int> &vertexCache,
     texcoords.push_back(in_texcoords[2 * i.vt_idx + 1]);
   }
 
-  unsigned int idx = static_cast<unsigned int>(positions.size() / 3 - 1);
-  vertexCache[i] = idx;
-
   return idx;
 }
 
@@ -355,32 +496,43 @@ void InitMaterial(material_t &material) {
   material.unknown_parameter.clear();
 }
 
-static bool exportFaceGroupToShape(
-    shape_t &shape, std::map<vertex_index, unsigned int> vertexCache,
-    const std::vector<float> &in_positions,
-    const std::vector<float> &in_normals,
-    const std::vector<float> &in_texcoords,
-    const std::vector<std::vector<vertex_index>> &faceGroup,
-    const int material_id, const std::string &name, bool clearCache) {
-  if (faceGroup.empty()) {
-    return false;
+// Calls triangle(i0, i1, i2) for every triangle of the faces.
+// Polygons are converted to triangle fans, points and lines do not produce
+// any triangles.
+template <typename Triangle>
+static void forEachTriangle(const face_range &faces, Triangle triangle) {
+  const vertex_index *face = faces.vertices;
+  for (size_t i = 0; i < faces.faces; i++) {
+    size_t npolys = faces.face_sizes[i];
+    for (size_t k = 2; k < npolys; k++)
+      triangle(face[0], face[k - 1], face[k]);
+    face += npolys;
   }
+}
 
-  // Flatten vertices and indices
-  for (size_t i = 0; i < faceGroup.size(); i++) {
-    const std::vector<vertex_index> &face = faceGroup[i];
-
-    vertex_index i0 = face[0];
-    vertex_index i1(-1);
-    vertex_index i2 = face[1];
-
-    size_t npolys = face.size();
+// Each shape gets its own vertices, the cache is emptied and reused.
+static bool exportFacesToShape(shape_t &shape, vertex_cache &vertexCache,
+                               const std::vector<float> &in_positions,
+                               const std::vector<float> &in_normals,
+                               const std::vector<float> &in_texcoords,
+                               const std::vector<face_range> &ranges,
+                               const int material_id, const std::string &name) {
+  size_t faceCount = 0, vertexCount = 0;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    faceCount += ranges[i].faces;
+    vertexCount += ranges[i].vertexCount;
+  }
+  if (faceCount == 0) {
+    return false;
+  }
 
-    // Polygon -> triangle fan conversion
-    for (size_t k = 2; k < npolys; k++) {
-      i1 = i2;
-      i2 = face[k];
+  vertexCache.reset(std::min(vertexCount, in_positions.size() / 3));
 
+  // Flatten vertices and indices
+  for (size_t i = 0; i < ranges.size(); i++) {
+    forEachTriangle(ranges[i], [&](const vertex_index &i0,
+                                   const vertex_index &i1,
+                                   const vertex_index &i2) {
       unsigned int v0 = updateVertex(
           vertexCache, shape.mesh.positions, shape.mesh.normals,
           shape.mesh.texcoords, in_positions, in_normals, in_texcoords, i0);
@@ -396,17 +548,27 @@ static bool exportFaceGroupToShape(
       shape.mesh.indices.push_back(v2);
 
       shape.mesh.material_ids.push_back(material_id);
-    }
+    });
   }
 
   shape.name = name;
 
-  if (clearCache)
-    vertexCache.clear();
-
   return true;
 }
 
+static bool exportFaceGroupToShape(
+    shape_t &shape, vertex_cache &vertexCache,
+    const std::vector<float> &in_positions,
+    const std::vector<float> &in_normals,
+    const std::vector<float> &in_texcoords,
+    const face_group &faceGroup, const int material_id,
+    const std::string &name) {
+  return exportFacesToShape(shape, vertexCache, in_positions, in_normals,
+                            in_texcoords,
+                            std::vector<face_range>(1, face_range(faceGroup)),
+                            material_id, name);
+}
+
 std::string LoadMtl(std::map<std::string, int> &material_map,
                     std::vector<material_t> &materials,
                     std::istream &inStream) {
@@ -692,12 +854,12 @@ std::string LoadObj(std::vector<shape_t> &shapes,
   std::vector<float> v;
   std::vector<float> vn;
   std::vector<float> vt;
-  std::vector<std::vector<vertex_index>> faceGroup;
+  face_group faceGroup;
   std::string name;
 
   // material
   std::map<std::string, int> material_map;
-  std::map<vertex_index, unsigned int> vertexCache;
+  vertex_cache vertexCache;
   int material = -1;
 
   shape_t shape;
@@ -772,17 +934,18 @@ std::string LoadObj(std::vector<shape_t> &shapes,
       token += 2;
       token += strspn(token, " \t");
 
-      std::vector<vertex_index> face;
+      unsigned int nverts = 0;
       while (!isNewLine(token[0])) {
         vertex_index vi = parseTriple(token, static_cast<int>(v.size() / 3),
                                       static_cast<int>(vn.size() / 3),
                                       static_cast<int>(vt.size() / 2));
-        face.push_back(vi);
+        faceGroup.vertices.push_back(vi);
+        nverts++;
         size_t n = strspn(token, " \t\r");
         token += n;
       }
 
-      faceGroup.push_back(face);
+      faceGroup.face_sizes.push_back(nverts);
 
       continue;
     }
@@ -800,7 +963,7 @@ std::string LoadObj(std::vector<shape_t> &shapes,
 
       // Create face group per material.
       bool ret = exportFaceGroupToShape(shape, vertexCache, v, vn, vt,
-                                        faceGroup, material, name, true);
+                                        faceGroup, material, name);
       if (ret) {
         shapes.push_back(shape);
       }
@@ -841,7 +1004,7 @@ std::string LoadObj(std::vector<shape_t> &shapes,
 
       // flush previous face group.
       bool ret = exportFaceGroupToShape(shape, vertexCache, v, vn, vt,
-                                        faceGroup, material, name, true);
+                                        faceGroup, material, name);
       if (ret) {
         shapes.push_back(shape);
       }
@@ -875,7 +1038,7 @@ std::string LoadObj(std::vector<shape_t> &shapes,
 
       // flush previous face group.
       bool ret = exportFaceGroupToShape(shape, vertexCache, v, vn, vt,
-                                        faceGroup, material, name, true);
+                                        faceGroup, material, name);
       if (ret) {
         shapes.push_back(shape);
       }
@@ -901,7 +1064,7 @@ std::string LoadObj(std::vector<shape_t> &shapes,
   }
 
   bool ret = exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
-                                    material, name, true);
+                                    material, name);
   if (ret) {
     shapes.push_back(shape);
   }
@@ -909,4 +1072,796 @@ std::string LoadObj(std::vector<shape_t> &shapes,
 
   return err.str();
 }
+
+//
+// Memory mapped loader.
+//
+// Lines are parsed in place from the mapped range, every line ends with '\n'
+// or '\0' (the last line is copied once when the file does not end with a new
+// line). The helpers below therefore never step over '\n' and never allocate.
+//
+
+static inline bool isTokenEnd(const char c) {
+  return isSpace(c) || isNewLine(c);
+}
+
+// Same as isspace, but stops at the end of the line.
+static inline bool isLineSpace(const char c) {
+  return isSpace(c) || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline void skipSpace(const char *&token) {
+  while (isSpace(token[0]))
+    token++;
+}
+
+static inline void skipTokenSpace(const char *&token) {
+  while (isSpace(token[0]) || token[0] == '\r')
+    token++;
+}
+
+// Equivalent of atoi limited to the current line.
+static inline int parseLineInt(const char *token) {
+  while (isLineSpace(token[0]))
+    token++;
+
+  bool negative = false;
+  if (token[0] == '+' || token[0] == '-') {
+    negative = (token[0] == '-');
+    token++;
+  }
+
+  int value = 0;
+  while (token[0] >= '0' && token[0] <= '9') {
+    value = value * 10 + (token[0] - '0');
+    token++;
+  }
+  return negative ? -value : value;
+}
+
+// Advances over an index of a face triple, stops at '/', white space or end of line.
+static inline void skipIndex(const char *&token) {
+  while (token[0] != '/' && !isTokenEnd(token[0]))
+    token++;
+}
+
+// Equivalent of sscanf(token, "%s", namebuf) limited to the current line.
+static inline std::string parseLineName(const char *token) {
+  while (isLineSpace(token[0]))
+    token++;
+  const char *end = token;
+  while (!isLineSpace(end[0]) && !isNewLine(end[0]))
+    end++;
+  return std::string(token, end);
+}
+
+// Powers of ten that are exactly representable as double.
+static const double exactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Fast path for the plain decimal numbers OBJ exporters write ("-1.234567").
+// With at most 15 significant digits both the mantissa and the power of ten are
+// exact doubles, so a single division gives the correctly rounded result.
+// Anything else (exponents, long mantissas, garbage) goes through tryParseDouble.
+static inline float parseLineFloat(const char *&token) {
+  skipSpace(token);
+  const char *end = token;
+  while (!isTokenEnd(end[0]))
+    end++;
+
+  const char *curr = token;
+  bool negative = false;
+  if (curr[0] == '+' || curr[0] == '-') {
+    negative = (curr[0] == '-');
+    curr++;
+  }
+
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int decimals = 0;
+  while (curr[0] >= '0' && curr[0] <= '9') {
+    mantissa = mantissa * 10 + static_cast<unsigned int>(curr[0] - '0');
+    digits++;
+    curr++;
+  }
+  if (digits > 0 && curr[0] == '.') {
+    curr++;
+    while (curr[0] >= '0' && curr[0] <= '9') {
+      mantissa = mantissa * 10 + static_cast<unsigned int>(curr[0] - '0');
+      digits++;
+      decimals++;
+      curr++;
+    }
+  }
+
+  double val = 0.0;
+  if (digits > 0 && digits <= 15 && curr == end) {
+    val = static_cast<double>(mantissa) / exactPowersOfTen[decimals];
+    if (negative)
+      val = -val;
+  } else {
+    tryParseDouble(token, end, &val);
+  }
+
+  token = end;
+  return static_cast<float>(val);
+}
+
+// Flags of vertex_index components given as negative (relative) indices.
+enum { RELATIVE_V = 1, RELATIVE_VT = 2, RELATIVE_VN = 4 };
+
+// Parse triples: i, i/j/k, i//k, i/j
+// Components written with relative indices are reported in 'relative'.
+static inline vertex_index parseLineTriple(const char *&token, int vsize,
+                                           int vnsize, int vtsize,
+                                           int &relative) {
+  vertex_index vi(-1);
+  relative = 0;
+
+  int idx = parseLineInt(token);
+  vi.v_idx = fixIndex(idx, vsize);
+  relative |= (idx < 0) ? RELATIVE_V : 0;
+  skipIndex(token);
+  if (token[0] != '/') {
+    return vi;
+  }
+  token++;
+
+  // i//k
+  if (token[0] == '/') {
+    token++;
+    idx = parseLineInt(token);
+    vi.vn_idx = fixIndex(idx, vnsize);
+    relative |= (idx < 0) ? RELATIVE_VN : 0;
+    skipIndex(token);
+    return vi;
+  }
+
+  // i/j/k or i/j
+  idx = parseLineInt(token);
+  vi.vt_idx = fixIndex(idx, vtsize);
+  relative |= (idx < 0) ? RELATIVE_VT : 0;
+  skipIndex(token);
+  if (token[0] != '/') {
+    return vi;
+  }
+
+  // i/j/k
+  token++; // skip '/'
+  idx = parseLineInt(token);
+  vi.vn_idx = fixIndex(idx, vnsize);
+  relative |= (idx < 0) ? RELATIVE_VN : 0;
+  skipIndex(token);
+  return vi;
+}
+
+// Geometry records of an OBJ file: v, vn, vt and f.
+// Both the sequential and the parallel loader parse these in the same way,
+// the parallel loader additionally remembers which face vertices used
+// relative indices so they can be moved once the chunk offsets are known.
+struct obj_geometry {
+  std::vector<float> v;
+  std::vector<float> vn;
+  std::vector<float> vt;
+  face_group faceGroup;
+
+  // Positions in faceGroup.vertices of relative v, vt and vn indices.
+  std::vector<size_t> relative_v, relative_vt, relative_vn;
+  bool trackRelative;
+
+  obj_geometry() : trackRelative(false) {}
+
+  // Parses a geometry record, token points after leading white space.
+  // Returns false if the line is not a geometry record.
+  bool parseRecord(const char *token);
+};
+
+bool obj_geometry::parseRecord(const char *token) {
+  // vertex
+  if (token[0] == 'v' && isSpace((token[1]))) {
+    token += 2;
+    float x = parseLineFloat(token);
+    float y = parseLineFloat(token);
+    float z = parseLineFloat(token);
+    v.push_back(x);
+    v.push_back(y);
+    v.push_back(z);
+    return true;
+  }
+
+  // normal
+  if (token[0] == 'v' && token[1] == 'n' && isSpace((token[2]))) {
+    token += 3;
+    float x = parseLineFloat(token);
+    float y = parseLineFloat(token);
+    float z = parseLineFloat(token);
+    vn.push_back(x);
+    vn.push_back(y);
+    vn.push_back(z);
+    return true;
+  }
+
+  // texcoord
+  if (token[0] == 'v' && token[1] == 't' && isSpace((token[2]))) {
+    token += 3;
+    float x = parseLineFloat(token);
+    float y = parseLineFloat(token);
+    vt.push_back(x);
+    vt.push_back(y);
+    return true;
+  }
+
+  // face
+  if (token[0] == 'f' && isSpace((token[1]))) {
+    token += 2;
+    skipSpace(token);
+
+    unsigned int nverts = 0;
+    while (!isNewLine(token[0])) {
+      int relative;
+      vertex_index vi = parseLineTriple(token, static_cast<int>(v.size() / 3),
+                                        static_cast<int>(vn.size() / 3),
+                                        static_cast<int>(vt.size() / 2),
+                                        relative);
+      if (relative && trackRelative) {
+        size_t position = faceGroup.vertices.size();
+        if (relative & RELATIVE_V)
+          relative_v.push_back(position);
+        if (relative & RELATIVE_VT)
+          relative_vt.push_back(position);
+        if (relative & RELATIVE_VN)
+          relative_vn.push_back(position);
+      }
+      faceGroup.vertices.push_back(vi);
+      nverts++;
+      skipTokenSpace(token);
+    }
+
+    faceGroup.face_sizes.push_back(nverts);
+    return true;
+  }
+
+  return false;
+}
+
+// Faces waiting to be converted into a shape, either an owned face group or
+// ranges borrowed from the parsed chunks.
+struct obj_pending_shape {
+  face_group faceGroup;
+  std::vector<face_range> ranges;
+  int material;
+  std::string name;
+};
+
+// Parser state that turns OBJ records into shapes.
+// Face groups are collected first and exported to shapes at the end, so the
+// vertex deduplication of independent shapes can run on several threads.
+struct obj_builder : obj_geometry {
+  std::string name;
+
+  std::map<std::string, int> material_map;
+  int material;
+
+  // Borrowed faces of the current shape, added by the parallel loader
+  std::vector<face_range> ranges;
+
+  std::vector<obj_pending_shape> pending;
+  std::vector<shape_t> &shapes;
+  std::vector<material_t> &materials;
+  MaterialReader &readMatFn;
+
+  obj_builder(std::vector<shape_t> &shapes,
+              std::vector<material_t> &materials, MaterialReader &readMatFn)
+      : material(-1), shapes(shapes), materials(materials),
+        readMatFn(readMatFn) {}
+
+  // Close the current face group, it becomes a new shape.
+  void flush() {
+    if (!faceGroup.empty() || !ranges.empty()) {
+      obj_pending_shape shape;
+      shape.faceGroup.vertices.swap(faceGroup.vertices);
+      shape.faceGroup.face_sizes.swap(faceGroup.face_sizes);
+      shape.ranges.swap(ranges);
+      shape.material = material;
+      shape.name = name;
+      pending.push_back(std::move(shape));
+    }
+    faceGroup.clear();
+    ranges.clear();
+  }
+
+  // Parses a single line, returns false and sets err when loading must stop.
+  bool parseLine(const char *token, std::string &err);
+
+  // Parses records that are not geometry: usemtl, mtllib, g and o.
+  // Returns false if the line is not one of them or loading must stop.
+  bool parseDirective(const char *token, std::string &err);
+
+  // Converts all pending face groups to shapes using up to num_threads threads.
+  void exportShapes(unsigned int num_threads);
+};
+
+// Directive lines change the current shape, material or name.
+static inline bool isDirective(const char *token) {
+  return ((0 == strncmp(token, "usemtl", 6)) && isSpace((token[6]))) ||
+         ((0 == strncmp(token, "mtllib", 6)) && isSpace((token[6]))) ||
+         (token[0] == 'g' && isSpace((token[1]))) ||
+         (token[0] == 'o' && isSpace((token[1])));
+}
+
+bool obj_builder::parseLine(const char *token, std::string &err) {
+  // Skip leading space.
+  skipSpace(token);
+
+  if (isNewLine(token[0]))
+    return true; // empty line
+
+  if (token[0] == '#')
+    return true; // comment line
+
+  if (parseRecord(token))
+    return true;
+
+  if (isDirective(token))
+    return parseDirective(token, err);
+
+  // Ignore unknown command.
+  return true;
+}
+
+bool obj_builder::parseDirective(const char *token, std::string &err) {
+  // use mtl
+  if ((0 == strncmp(token, "usemtl", 6)) && isSpace((token[6]))) {
+    std::string matname = parseLineName(token + 7);
+
+    // Create face group per material.
+    flush();
+
+    std::map<std::string, int>::const_iterator it = material_map.find(matname);
+    if (it != material_map.end()) {
+      material = it->second;
+    } else {
+      // { error!! material not found }
+      material = -1;
+    }
+    return true;
+  }
+
+  // load mtl
+  if ((0 == strncmp(token, "mtllib", 6)) && isSpace((token[6]))) {
+    std::string err_mtl =
+        readMatFn(parseLineName(token + 7), materials, material_map);
+    if (!err_mtl.empty()) {
+      faceGroup.clear(); // for safety
+      ranges.clear();
+      err = err_mtl;
+      return false;
+    }
+    return true;
+  }
+
+  // group name
+  if (token[0] == 'g' && isSpace((token[1]))) {
+    // flush previous face group.
+    flush();
+
+    // names[0] must be 'g', so skip it and keep the first group name.
+    token += 1;
+    skipTokenSpace(token);
+    const char *end = token;
+    while (!isTokenEnd(end[0]))
+      end++;
+    name = std::string(token, end);
+    return true;
+  }
+
+  // object name
+  if (token[0] == 'o' && isSpace((token[1]))) {
+    // flush previous face group.
+    flush();
+
+    // @todo { multiple object name? }
+    name = parseLineName(token + 2);
+    return true;
+  }
+
+  return false;
+}
+
+// Shapes with fewer face vertices are deduplicated on a single thread.
+#ifndef TINYOBJ_MIN_DEDUP_VERTICES
+#define TINYOBJ_MIN_DEDUP_VERTICES (64 * 1024)
+#endif
+
+// Calls task(i) for every i in [0, count) on up to num_threads threads.
+template <typename Task>
+static void parallelFor(size_t count, unsigned int num_threads, Task task) {
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++)
+      task(i);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < num_threads && i < count; i++)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+// Faces of a large shape that are deduplicated on their own.
+struct dedup_part {
+  face_range faces;
+  std::vector<vertex_index> unique;  // vertices in the order of first use
+  std::vector<unsigned int> indices; // triangle indices into unique
+  std::vector<unsigned int> remap;   // shape vertex of each unique vertex
+  size_t first;                      // first index of the part in the shape
+
+  explicit dedup_part(const face_range &faces) : faces(faces), first(0) {}
+};
+
+// Deduplicates the vertices of one shape on up to num_threads threads.
+// Every part of the faces gets a local cache, then the unique vertices of the
+// parts are merged in face order. This numbers the vertices in the order of
+// first use like exportFacesToShape, but the sequential merge sees each
+// vertex about once per part instead of once per face that uses it.
+static void exportLargeShape(shape_t &shape,
+                             const std::vector<float> &in_positions,
+                             const std::vector<float> &in_normals,
+                             const std::vector<float> &in_texcoords,
+                             const std::vector<face_range> &ranges,
+                             const int material_id, const std::string &name,
+                             unsigned int num_threads) {
+  size_t vertexCount = 0;
+  for (auto &range : ranges)
+    vertexCount += range.vertexCount;
+  size_t partSize = vertexCount / num_threads + 1;
+
+  // Cut the ranges at face boundaries
+  std::vector<dedup_part> parts;
+  for (auto &range : ranges) {
+    size_t first = 0, firstVertex = 0, vertex = 0;
+    for (size_t face = 0; face < range.faces; face++) {
+      vertex += range.face_sizes[face];
+      if (vertex - firstVertex >= partSize || face + 1 == range.faces) {
+        parts.push_back(
+            dedup_part(range.slice(first, face + 1, firstVertex, vertex)));
+        first = face + 1;
+        firstVertex = vertex;
+      }
+    }
+  }
+
+  parallelFor(parts.size(), num_threads, [&](size_t p) {
+    dedup_part &part = parts[p];
+    vertex_cache cache;
+    cache.reset(std::min(part.faces.vertexCount, in_positions.size() / 3));
+    auto add = [&](const vertex_index &i) {
+      bool found;
+      part.indices.push_back(cache.insert(
+          i, static_cast<unsigned int>(part.unique.size()), found));
+      if (!found)
+        part.unique.push_back(i);
+    };
+    forEachTriangle(part.faces, [&](const vertex_index &i0,
+                                    const vertex_index &i1,
+                                    const vertex_index &i2) {
+      add(i0);
+      add(i1);
+      add(i2);
+    });
+  });
+
+  // Merge the unique vertices in face order
+  vertex_cache vertexCache;
+  vertexCache.reset(std::min(vertexCount, in_positions.size() / 3));
+  size_t indexCount = 0;
+  for (auto &part : parts) {
+    part.first = indexCount;
+    indexCount += part.indices.size();
+    part.remap.resize(part.unique.size());
+    for (size_t i = 0; i < part.unique.size(); i++)
+      part.remap[i] = updateVertex(
+          vertexCache, shape.mesh.positions, shape.mesh.normals,
+          shape.mesh.texcoords, in_positions, in_normals, in_texcoords,
+          part.unique[i]);
+  }
+
+  shape.mesh.indices.resize(indexCount);
+  parallelFor(parts.size(), num_threads, [&](size_t p) {
+    const dedup_part &part = parts[p];
+    unsigned int *indices = shape.mesh.indices.data() + part.first;
+    for (size_t i = 0; i < part.indices.size(); i++)
+      indices[i] = part.remap[part.indices[i]];
+  });
+  shape.mesh.material_ids.assign(indexCount / 3, material_id);
+
+  shape.name = name;
+}
+
+void obj_builder::exportShapes(unsigned int num_threads) {
+  size_t first = shapes.size();
+  shapes.resize(first + pending.size());
+
+  // Large shapes use all threads one after another, the rest go to workers
+  std::vector<size_t> small;
+  for (size_t i = 0; i < pending.size(); i++) {
+    obj_pending_shape &shape = pending[i];
+    if (!shape.faceGroup.empty())
+      shape.ranges.push_back(face_range(shape.faceGroup));
+
+    size_t vertexCount = 0;
+    for (auto &range : shape.ranges)
+      vertexCount += range.vertexCount;
+    size_t partCount = std::min<size_t>(
+        num_threads, vertexCount / TINYOBJ_MIN_DEDUP_VERTICES);
+    if (partCount > 1) {
+      exportLargeShape(shapes[first + i], v, vn, vt, shape.ranges,
+                       shape.material, shape.name,
+                       static_cast<unsigned int>(partCount));
+      shape = obj_pending_shape();
+    } else {
+      small.push_back(i);
+    }
+  }
+
+  // Small shapes are independent, each worker takes the next unexported one.
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    vertex_cache vertexCache;
+    for (size_t n = next++; n < small.size(); n = next++) {
+      obj_pending_shape &shape = pending[small[n]];
+      exportFacesToShape(shapes[first + small[n]], vertexCache, v, vn, vt,
+                         shape.ranges, shape.material, shape.name);
+      shape = obj_pending_shape();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < num_threads && i < small.size(); i++)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+
+  pending.clear();
+}
+
+// Splits a mapped range into lines that all end with '\n' or '\0'.
+// The last line is copied when it is not terminated, so no helper reads past the range.
+struct obj_lines {
+  const char *begin;
+  const char *end;
+  std::string lastLine;
+
+  obj_lines(const char *data, size_t size) : begin(data), end(data + size) {
+    if (size > 0 && end[-1] != '\n') {
+      const char *lastLineStart = end;
+      while (lastLineStart > begin && lastLineStart[-1] != '\n')
+        lastLineStart--;
+      lastLine.assign(lastLineStart, end);
+      end = lastLineStart;
+    }
+  }
+
+  // Calls parse for each line in [from, to), stops when it returns false.
+  template <typename Parse>
+  static bool forEach(const char *from, const char *to, Parse parse) {
+    for (const char *line = from; line < to;) {
+      const char *next = static_cast<const char *>(
+          memchr(line, '\n', static_cast<size_t>(to - line)));
+      if (!parse(line))
+        return false;
+      line = next + 1;
+    }
+    return true;
+  }
+};
+
+std::string LoadObj(std::vector<shape_t> &shapes,
+                    std::vector<material_t> &materials, // [output]
+                    const char *data, size_t size, MaterialReader &readMatFn) {
+  shapes.clear();
+
+  obj_builder builder(shapes, materials, readMatFn);
+  std::string err;
+
+  obj_lines lines(data, size);
+  auto parse = [&](const char *line) { return builder.parseLine(line, err); };
+  if (obj_lines::forEach(lines.begin, lines.end, parse) &&
+      !lines.lastLine.empty())
+    parse(lines.lastLine.c_str());
+
+  builder.flush();
+  builder.exportShapes(1);
+  return err;
+}
+
+std::string LoadObjMapped(std::vector<shape_t> &shapes,
+                          std::vector<material_t> &materials, // [output]
+                          const char *filename, const char *mtl_basepath) {
+  shapes.clear();
+
+  std::stringstream err;
+
+  MappedFile file(filename);
+  if (!file.IsOpen()) {
+    err << "Cannot open file [" << filename << "]" << std::endl;
+    return err.str();
+  }
+
+  std::string basePath;
+  if (mtl_basepath) {
+    basePath = mtl_basepath;
+  }
+  MaterialFileReader matFileReader(basePath);
+
+  return LoadObj(shapes, materials, file.Data(), file.Size(), matFileReader);
+}
+
+//
+// Parallel loader.
+//
+// The mapped range is split into chunks at line boundaries. Each worker parses
+// the geometry records of its chunk and remembers where the directives
+// (usemtl, mtllib, g, o) appeared relative to its faces. The chunks are then
+// merged in order: vertex arrays are concatenated, relative face indices are
+// moved by the chunk offsets and the directives are replayed, which gives the
+// same face groups as a sequential parse. The shapes refer to the faces of the
+// chunks and large shapes are deduplicated by several threads.
+//
+
+// Chunks smaller than this are not worth a thread.
+#ifndef TINYOBJ_MIN_CHUNK_SIZE
+#define TINYOBJ_MIN_CHUNK_SIZE (256 * 1024)
+#endif
+
+struct obj_directive {
+  const char *line;
+  size_t face;   // number of chunk faces parsed before the directive
+  size_t vertex; // number of chunk face vertices parsed before the directive
+};
+
+struct obj_chunk : obj_geometry {
+  std::vector<obj_directive> directives;
+
+  obj_chunk() { trackRelative = true; }
+
+  void parse(const char *from, const char *to, const std::string &lastLine) {
+    auto parse = [this](const char *token) {
+      skipSpace(token);
+      if (isNewLine(token[0]) || token[0] == '#' || parseRecord(token))
+        return true;
+      if (isDirective(token)) {
+        obj_directive directive = {token, faceGroup.face_sizes.size(),
+                                   faceGroup.vertices.size()};
+        directives.push_back(directive);
+      }
+      return true;
+    };
+    obj_lines::forEach(from, to, parse);
+    if (!lastLine.empty())
+      parse(lastLine.c_str());
+  }
+};
+
+// Adds the chunk faces between two directives to the current shape.
+static void appendFaces(obj_builder &builder, const face_range &chunkFaces,
+                        size_t first, size_t last, size_t firstVertex,
+                        size_t lastVertex) {
+  if (first < last)
+    builder.ranges.push_back(
+        chunkFaces.slice(first, last, firstVertex, lastVertex));
+}
+
+std::string LoadObjParallel(std::vector<shape_t> &shapes,
+                            std::vector<material_t> &materials, // [output]
+                            const char *filename, const char *mtl_basepath,
+                            unsigned int num_threads) {
+  shapes.clear();
+
+  std::stringstream err;
+
+  MappedFile file(filename);
+  if (!file.IsOpen()) {
+    err << "Cannot open file [" << filename << "]" << std::endl;
+    return err.str();
+  }
+
+  std::string basePath;
+  if (mtl_basepath) {
+    basePath = mtl_basepath;
+  }
+  MaterialFileReader matFileReader(basePath);
+
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Split at line boundaries
+  obj_lines lines(file.Data(), file.Size());
+  size_t size = static_cast<size_t>(lines.end - lines.begin);
+  size_t chunkCount = std::max<size_t>(
+      1, std::min<size_t>(num_threads, size / TINYOBJ_MIN_CHUNK_SIZE));
+  std::vector<const char *> bounds(chunkCount + 1, lines.end);
+  bounds[0] = lines.begin;
+  for (size_t i = 1; i < chunkCount; i++) {
+    const char *split = std::max(bounds[i - 1], lines.begin + size * i / chunkCount);
+    const char *newLine = static_cast<const char *>(
+        memchr(split, '\n', static_cast<size_t>(lines.end - split)));
+    bounds[i] = newLine ? newLine + 1 : lines.end;
+  }
+
+  // Parse chunks, the last one also takes the unterminated last line
+  std::vector<obj_chunk> chunks(chunkCount);
+  std::string noLine;
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < chunkCount; i++)
+    threads.push_back(std::thread([&, i]() {
+      chunks[i].parse(bounds[i], bounds[i + 1],
+                      i + 1 == chunkCount ? lines.lastLine : noLine);
+    }));
+  chunks[0].parse(bounds[0], bounds[1],
+                  chunkCount == 1 ? lines.lastLine : noLine);
+  for (auto &thread : threads)
+    thread.join();
+
+  // Merge vertex data
+  obj_builder builder(shapes, materials, matFileReader);
+  size_t vTotal = 0, vnTotal = 0, vtTotal = 0;
+  for (auto &chunk : chunks) {
+    vTotal += chunk.v.size();
+    vnTotal += chunk.vn.size();
+    vtTotal += chunk.vt.size();
+  }
+  builder.v.reserve(vTotal);
+  builder.vn.reserve(vnTotal);
+  builder.vt.reserve(vtTotal);
+
+  for (auto &chunk : chunks) {
+    // Relative indices were resolved against the chunk, move them by the preceding vertex counts
+    int vOffset = static_cast<int>(builder.v.size() / 3);
+    int vnOffset = static_cast<int>(builder.vn.size() / 3);
+    int vtOffset = static_cast<int>(builder.vt.size() / 2);
+    for (size_t position : chunk.relative_v)
+      chunk.faceGroup.vertices[position].v_idx += vOffset;
+    for (size_t position : chunk.relative_vn)
+      chunk.faceGroup.vertices[position].vn_idx += vnOffset;
+    for (size_t position : chunk.relative_vt)
+      chunk.faceGroup.vertices[position].vt_idx += vtOffset;
+
+    builder.v.insert(builder.v.end(), chunk.v.begin(), chunk.v.end());
+    builder.vn.insert(builder.vn.end(), chunk.vn.begin(), chunk.vn.end());
+    builder.vt.insert(builder.vt.end(), chunk.vt.begin(), chunk.vt.end());
+    std::vector<float>().swap(chunk.v);
+    std::vector<float>().swap(chunk.vn);
+    std::vector<float>().swap(chunk.vt);
+  }
+
+  // Replay faces and directives in file order, the shapes refer to the faces
+  // of the chunks, so these stay alive until the shapes are exported
+  std::string parseErr;
+  for (auto &chunk : chunks) {
+    face_range chunkFaces(chunk.faceGroup);
+    size_t face = 0, vertex = 0;
+    for (auto &directive : chunk.directives) {
+      appendFaces(builder, chunkFaces, face, directive.face, vertex,
+                  directive.vertex);
+      face = directive.face;
+      vertex = directive.vertex;
+      if (!builder.parseDirective(directive.line, parseErr)) {
+        builder.flush();
+        builder.exportShapes(num_threads);
+        return parseErr;
+      }
+    }
+    appendFaces(builder, chunkFaces, face, chunkFaces.faces, vertex,
+                chunkFaces.vertexCount);
+  }
+
+  builder.flush();
+  builder.exportShapes(num_threads);
+  return parseErr;
+}
 }
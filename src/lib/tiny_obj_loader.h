@@ -88,6 +88,32 @@ std::string LoadObj(std::vector<shape_t> &shapes,       // [output]
                     std::vector<material_t> &materials, // [output]
                     std::istream &inStream, MaterialReader &readMatFn);
 
+/// Loads .obj from a memory mapped file.
+/// Lines are parsed in place without per line allocations and the output is
+/// identical to LoadObj. Returns empty string when loading .obj success.
+std::string LoadObjMapped(std::vector<shape_t> &shapes,       // [output]
+                          std::vector<material_t> &materials, // [output]
+                          const char *filename,
+                          const char *mtl_basepath = nullptr);
+
+/// Loads .obj from a memory mapped file using up to num_threads threads.
+/// The file is split into chunks at line boundaries which are parsed in
+/// parallel and merged in order, shapes and the parts of large shapes are
+/// then deduplicated in parallel.
+/// The output is identical to LoadObj, num_threads == 0 uses all cores.
+/// Returns empty string when loading .obj success.
+std::string LoadObjParallel(std::vector<shape_t> &shapes,       // [output]
+                            std::vector<material_t> &materials, // [output]
+                            const char *filename,
+                            const char *mtl_basepath = nullptr,
+                            unsigned int num_threads = 0);
+
+/// Loads object from a memory range, uses readMatFn to retrieve materials.
+/// Returns empty string when loading .obj success.
+std::string LoadObj(std::vector<shape_t> &shapes,       // [output]
+                    std::vector<material_t> &materials, // [output]
+                    const char *data, size_t size, MaterialReader &readMatFn);
+
 /// Loads materials into std::map
 /// Returns an empty string if successful
 std::string LoadMtl(std::map<std::string, int> &material_map,
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PPGSO_TRANSFORM_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "transform.h"
+
+// Same terms as glm::yawPitchRoll with yaw = rotation.z, pitch = rotation.x, roll = rotation.y
+glm::mat4 ComposeTransform(const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale) {
+  float ch = std::cos(rotation.z), sh = std::sin(rotation.z);
+  float cp = std::cos(rotation.x), sp = std::sin(rotation.x);
+  float cb = std::cos(rotation.y), sb = std::sin(rotation.y);
+
+  glm::mat4 result;
+  result[0] = glm::vec4{ch * cb + sh * sp * sb, sb * cp, -sh * cb + ch * sp * sb, 0.0f} * scale.x;
+  result[1] = glm::vec4{-ch * sb + sh * sp * cb, cb * cp, sb * sh + ch * sp * cb, 0.0f} * scale.y;
+  result[2] = glm::vec4{sh * cp, -sp, ch * cp, 0.0f} * scale.z;
+  result[3] = glm::vec4{position, 1.0f};
+  return result;
+}
+
+#ifdef PPGSO_TRANSFORM_SSE2
+
+// Sine and cosine of four angles
+// The angle is reduced to [-pi/4, pi/4] by a multiple of pi/2 split in three parts to keep the precision
+// Minimax polynomials of the Cephes library are evaluated on the remainder, the quadrant selects and negates them
+static inline void SinCos4(__m128 x, __m128 &sine, __m128 &cosine) {
+  const __m128 TWO_OVER_PI = _mm_set1_ps(0.636619772367581343f);
+  const __m128 PI_2_A = _mm_set1_ps(1.5703125f);
+  const __m128 PI_2_B = _mm_set1_ps(4.837512969970703125e-4f);
+  const __m128 PI_2_C = _mm_set1_ps(7.54978995489188216e-8f);
+
+  __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, TWO_OVER_PI));
+  __m128 q = _mm_cvtepi32_ps(quadrant);
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, PI_2_A));
+  r = _mm_sub_ps(r, _mm_mul_ps(q, PI_2_B));
+  r = _mm_sub_ps(r, _mm_mul_ps(q, PI_2_C));
+  __m128 r2 = _mm_mul_ps(r, r);
+
+  __m128 s = _mm_set1_ps(-1.9515295891e-4f);
+  s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(8.3321608736e-3f));
+  s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+  s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+  __m128 c = _mm_set1_ps(2.443315711809948e-5f);
+  c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.388731625493765e-3f));
+  c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+  c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+  c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+  // Odd quadrants swap sine and cosine, sine is negative in quadrants 2 and 3, cosine in quadrants 1 and 2
+  const __m128i ONE = _mm_set1_epi32(1);
+  const __m128i TWO = _mm_set1_epi32(2);
+  __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, ONE), ONE));
+  __m128 sine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, TWO), 30));
+  __m128 cosine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, ONE), TWO), 30));
+
+  sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+  cosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+  sine = _mm_xor_ps(sine, sine_sign);
+  cosine = _mm_xor_ps(cosine, cosine_sign);
+}
+
+// One component of four consecutive vectors
+static inline __m128 Load4(const glm::vec3 *v, int component) {
+  return _mm_setr_ps(v[0][component], v[1][component], v[2][component], v[3][component]);
+}
+
+// Matrices are computed element by element for four objects, then transposed into columns
+static void ComposeTransforms4(const glm::vec3 *position, const glm::vec3 *rotation, const glm::vec3 *scale,
+                               glm::mat4 *modelMatrix) {
+  __m128 sh, ch, sp, cp, sb, cb;
+  SinCos4(Load4(rotation, 2), sh, ch);
+  SinCos4(Load4(rotation, 0), sp, cp);
+  SinCos4(Load4(rotation, 1), sb, cb);
+  __m128 sx = Load4(scale, 0), sy = Load4(scale, 1), sz = Load4(scale, 2);
+  __m128 spsb = _mm_mul_ps(sp, sb), spcb = _mm_mul_ps(sp, cb);
+
+  __m128 columns[4][4];
+  columns[0][0] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ch, cb), _mm_mul_ps(sh, spsb)), sx);
+  columns[0][1] = _mm_mul_ps(_mm_mul_ps(sb, cp), sx);
+  columns[0][2] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ch, spsb), _mm_mul_ps(sh, cb)), sx);
+  columns[1][0] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sh, spcb), _mm_mul_ps(ch, sb)), sy);
+  columns[1][1] = _mm_mul_ps(_mm_mul_ps(cb, cp), sy);
+  columns[1][2] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sb, sh), _mm_mul_ps(ch, spcb)), sy);
+  columns[2][0] = _mm_mul_ps(_mm_mul_ps(sh, cp), sz);
+  columns[2][1] = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), sp), sz);
+  columns[2][2] = _mm_mul_ps(_mm_mul_ps(ch, cp), sz);
+  columns[0][3] = columns[1][3] = columns[2][3] = _mm_setzero_ps();
+  columns[3][0] = Load4(position, 0);
+  columns[3][1] = Load4(position, 1);
+  columns[3][2] = Load4(position, 2);
+  columns[3][3] = _mm_set1_ps(1.0f);
+
+  for (int column = 0; column < 4; column++) {
+    auto &c = columns[column];
+    _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+    for (int object = 0; object < 4; object++) _mm_storeu_ps(&modelMatrix[object][column][0], c[object]);
+  }
+}
+
+#endif // PPGSO_TRANSFORM_SSE2
+
+size_t ComposeTransforms(const glm::vec3 *position, const glm::vec3 *rotation, const glm::vec3 *scale,
+                         uint8_t *dirty, glm::mat4 *modelMatrix, size_t count) {
+  size_t composed = 0;
+  size_t i = 0;
+
+#ifdef PPGSO_TRANSFORM_SSE2
+  // Blocks without a dirty object are skipped, clean objects in a dirty block are recomposed to the same matrix
+  for (; i + 4 <= count; i += 4) {
+    if (dirty) {
+      uint32_t flags;
+      memcpy(&flags, dirty + i, sizeof(flags));
+      if (!flags) continue;
+      for (int j = 0; j < 4; j++) composed += dirty[i + j] != 0;
+      memset(dirty + i, 0, 4);
+    } else {
+      composed += 4;
+    }
+    ComposeTransforms4(position + i, rotation + i, scale + i, modelMatrix + i);
+  }
+#endif
+
+  for (; i < count; i++) {
+    if (dirty) {
+      if (!dirty[i]) continue;
+      dirty[i] = 0;
+    }
+    modelMatrix[i] = ComposeTransform(position[i], rotation[i], scale[i]);
+    composed++;
+  }
+  return composed;
+}
+
+bool IsTransformSimd() {
+#ifdef PPGSO_TRANSFORM_SSE2
+  return true;
+#else
+  return false;
+#endif
+}
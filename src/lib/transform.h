@@ -0,0 +1,27 @@
+#ifndef PPGSO_TRANSFORM_H
+#define PPGSO_TRANSFORM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+// Model matrices from position, euler rotation and scale
+// The result equals translate(position) * orientate4(rotation) * scale(scale) of GLM
+// The rotation and the scaled columns are written directly, no intermediate matrices are multiplied
+
+// Composes one model matrix
+glm::mat4 ComposeTransform(const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale);
+
+// Composes model matrices of count objects stored as arrays of positions, rotations and scales
+// Only entries with a non-zero dirty flag are written and their flags are cleared, nullptr composes all of them
+// With SSE2 four matrices are composed at once, sine and cosine use a polynomial with about 1e-7 error
+// Returns the number of matrices brought up to date
+size_t ComposeTransforms(const glm::vec3 *position, const glm::vec3 *rotation, const glm::vec3 *scale,
+                         uint8_t *dirty, glm::mat4 *modelMatrix, size_t count);
+
+// True when ComposeTransforms uses the SSE2 kernel
+bool IsTransformSimd();
+
+#endif // PPGSO_TRANSFORM_H
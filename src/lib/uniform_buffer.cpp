@@ -0,0 +1,25 @@
+#include "uniform_buffer.h"
+
+UniformBuffer::UniformBuffer(GLsizeiptr size) : size(size) {
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+}
+
+UniformBuffer::~UniformBuffer() {
+  glDeleteBuffers(1, &buffer);
+}
+
+void UniformBuffer::Update(const void *data) {
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+}
+
+void UniformBuffer::Bind(GLuint binding) {
+  glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+GLsizeiptr UniformBuffer::GetSize() const {
+  return size;
+}
@@ -0,0 +1,33 @@
+#ifndef PPGSO_UNIFORM_BUFFER_H
+#define PPGSO_UNIFORM_BUFFER_H
+
+#include <memory>
+
+#include <GL/glew.h>
+
+// Uniform buffer object shared by all programs that declare the matching uniform block
+// Programs get their blocks bound to the UniformBlockBinding points from shader.h when they are linked
+// Upload the data once per frame and bind the buffer to its binding point, no per-draw uniform calls are needed
+class UniformBuffer {
+public:
+  UniformBuffer(GLsizeiptr size);
+  ~UniformBuffer();
+
+  // Replaces the whole buffer content, the previous storage is orphaned so the draws still using it do not stall
+  void Update(const void *data);
+  // Makes the buffer visible to all blocks using the binding point
+  void Bind(GLuint binding);
+
+  GLsizeiptr GetSize() const;
+
+private:
+  // Buffers own an OpenGL name, do not copy them
+  UniformBuffer(const UniformBuffer &) = delete;
+  UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+  GLuint buffer;
+  GLsizeiptr size;
+};
+typedef std::shared_ptr<UniformBuffer> UniformBufferPtr;
+
+#endif // PPGSO_UNIFORM_BUFFER_H
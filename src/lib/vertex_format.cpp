@@ -0,0 +1,137 @@
+#include <cstring>
+
+#include <glm/gtc/packing.hpp>
+
+#include "vertex_format.h"
+
+VertexLayout VertexLayout::Get(VertexFormat format) {
+  VertexLayout layout;
+  layout.position_offset = 0;
+  layout.normal_offset = 3 * sizeof(float);
+  if (format == VertexFormat::Quantized) {
+    layout.texcoord_offset = layout.normal_offset + sizeof(uint32_t);
+    layout.stride = layout.texcoord_offset + sizeof(uint32_t);
+  } else {
+    layout.texcoord_offset = layout.normal_offset + 3 * sizeof(float);
+    layout.stride = layout.texcoord_offset + 2 * sizeof(float);
+  }
+  return layout;
+}
+
+size_t GetIndexSize(size_t vertex_count) {
+  return vertex_count <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+uint32_t PackNormal(float x, float y, float z) {
+  return glm::packSnorm3x10_1x2(glm::vec4{x, y, z, 0.0f});
+}
+
+uint32_t PackTexCoord(float u, float v) {
+  return glm::packHalf2x16(glm::vec2{u, v});
+}
+
+// Writes interleaved vertices of one shape, missing normals and texture coordinates are written as zeros
+static void PackVertices(const tinyobj::mesh_t &mesh, VertexFormat format, const VertexLayout &layout,
+                         uint8_t *vertex) {
+  size_t count = mesh.positions.size() / 3;
+  bool has_normals = mesh.normals.size() == count * 3;
+  bool has_texcoords = mesh.texcoords.size() == count * 2;
+
+  for (size_t i = 0; i < count; i++, vertex += layout.stride) {
+    memcpy(vertex + layout.position_offset, &mesh.positions[3 * i], 3 * sizeof(float));
+
+    if (format == VertexFormat::Quantized) {
+      uint32_t normal = has_normals ? PackNormal(mesh.normals[3 * i], mesh.normals[3 * i + 1], mesh.normals[3 * i + 2]) : 0;
+      uint32_t texcoord = has_texcoords ? PackTexCoord(mesh.texcoords[2 * i], mesh.texcoords[2 * i + 1]) : 0;
+      memcpy(vertex + layout.normal_offset, &normal, sizeof(normal));
+      memcpy(vertex + layout.texcoord_offset, &texcoord, sizeof(texcoord));
+    } else {
+      if (has_normals)
+        memcpy(vertex + layout.normal_offset, &mesh.normals[3 * i], 3 * sizeof(float));
+      else
+        memset(vertex + layout.normal_offset, 0, 3 * sizeof(float));
+      if (has_texcoords)
+        memcpy(vertex + layout.texcoord_offset, &mesh.texcoords[2 * i], 2 * sizeof(float));
+      else
+        memset(vertex + layout.texcoord_offset, 0, 2 * sizeof(float));
+    }
+  }
+}
+
+template<typename Index>
+static void PackIndices(const std::vector<tinyobj::shape_t> &shapes, size_t material_count,
+                        std::vector<size_t> &next, uint8_t *indices) {
+  auto output = (Index *) indices;
+  Index base_vertex = 0;
+  for (auto &shape : shapes) {
+    auto &mesh = shape.mesh;
+    for (size_t i = 0; i < mesh.indices.size() / 3; i++) {
+      int material_id = i < mesh.material_ids.size() ? mesh.material_ids[i] : -1;
+      size_t bucket = material_id >= 0 && (size_t) material_id < material_count ? (size_t) material_id + 1 : 0;
+      Index *triangle = output + next[bucket];
+      triangle[0] = (Index) (base_vertex + mesh.indices[3 * i + 0]);
+      triangle[1] = (Index) (base_vertex + mesh.indices[3 * i + 1]);
+      triangle[2] = (Index) (base_vertex + mesh.indices[3 * i + 2]);
+      next[bucket] += 3;
+    }
+    base_vertex = (Index) (base_vertex + mesh.positions.size() / 3);
+  }
+}
+
+PackedMesh PackMesh(const std::vector<tinyobj::shape_t> &shapes, size_t material_count, VertexFormat format) {
+  PackedMesh packed;
+  packed.format = format;
+  packed.layout = VertexLayout::Get(format);
+  packed.has_normals = false;
+  packed.has_texcoords = false;
+  packed.vertex_count = 0;
+  packed.index_count = 0;
+
+  // Count vertices and indices per material, bucket 0 holds faces without material
+  std::vector<size_t> bucket_counts(material_count + 1, 0);
+  std::vector<size_t> bucket_shapes(material_count + 1, shapes.size());
+  for (size_t s = 0; s < shapes.size(); s++) {
+    auto &mesh = shapes[s].mesh;
+    packed.vertex_count += mesh.positions.size() / 3;
+    packed.has_normals |= !mesh.normals.empty();
+    packed.has_texcoords |= !mesh.texcoords.empty();
+    for (size_t i = 0; i < mesh.indices.size() / 3; i++) {
+      int material_id = i < mesh.material_ids.size() ? mesh.material_ids[i] : -1;
+      size_t bucket = material_id >= 0 && (size_t) material_id < material_count ? (size_t) material_id + 1 : 0;
+      bucket_counts[bucket] += 3;
+      if (bucket_shapes[bucket] == shapes.size()) bucket_shapes[bucket] = s;
+    }
+  }
+
+  // Ranges follow the material order, faces keep the file order within a range
+  std::vector<size_t> next(bucket_counts.size());
+  for (size_t bucket = 0; bucket < bucket_counts.size(); bucket++) {
+    next[bucket] = packed.index_count;
+    if (bucket_counts[bucket] > 0) {
+      PackedMesh::Range range;
+      range.name = shapes[bucket_shapes[bucket]].name;
+      range.material_id = (int) bucket - 1;
+      range.index_offset = packed.index_count;
+      range.index_count = bucket_counts[bucket];
+      packed.ranges.push_back(range);
+    }
+    packed.index_count += bucket_counts[bucket];
+  }
+
+  // Single allocation for each buffer, written in place
+  packed.vertices.resize(packed.vertex_count * packed.layout.stride);
+  size_t offset = 0;
+  for (auto &shape : shapes) {
+    PackVertices(shape.mesh, format, packed.layout, packed.vertices.data() + offset);
+    offset += shape.mesh.positions.size() / 3 * packed.layout.stride;
+  }
+
+  packed.index_size = GetIndexSize(packed.vertex_count);
+  packed.indices.resize(packed.index_count * packed.index_size);
+  if (packed.index_size == sizeof(uint16_t))
+    PackIndices<uint16_t>(shapes, material_count, next, packed.indices.data());
+  else
+    PackIndices<uint32_t>(shapes, material_count, next, packed.indices.data());
+
+  return packed;
+}
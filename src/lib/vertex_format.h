@@ -0,0 +1,65 @@
+#ifndef PPGSO_VERTEX_FORMAT_H
+#define PPGSO_VERTEX_FORMAT_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "tiny_obj_loader.h"
+
+// Storage of vertex attributes in a single interleaved buffer
+// Float:     position 3 x float, normal 3 x float, texcoord 2 x float, 32 bytes per vertex
+// Quantized: position 3 x float, normal packed signed 10:10:10:2, texcoord 2 x half float, 20 bytes per vertex
+enum class VertexFormat {
+  Float,
+  Quantized
+};
+
+// Byte layout of one interleaved vertex
+struct VertexLayout {
+  size_t stride;
+  size_t position_offset;
+  size_t normal_offset;
+  size_t texcoord_offset;
+
+  static VertexLayout Get(VertexFormat format);
+};
+
+// Interleaved vertices and indices of all shapes of an OBJ file ready for upload
+// Indices are grouped by material, each group is one range of the index buffer
+// Indices are 16bit when all vertices can be addressed with them, 32bit otherwise
+struct PackedMesh {
+  struct Range {
+    std::string name;   // name of the first shape in the range
+    int material_id;    // -1 for faces without material
+    size_t index_offset;
+    size_t index_count;
+  };
+
+  VertexFormat format;
+  VertexLayout layout;
+  bool has_normals;
+  bool has_texcoords;
+  size_t vertex_count;
+  size_t index_count;
+  size_t index_size;
+  std::vector<uint8_t> vertices;
+  std::vector<uint8_t> indices;
+  std::vector<Range> ranges;
+};
+
+// Size of one index in bytes for the given number of vertices
+size_t GetIndexSize(size_t vertex_count);
+
+// Packs a normal into the signed normalized 10:10:10:2 format, w is zero
+uint32_t PackNormal(float x, float y, float z);
+
+// Packs two floats into half floats, u in the low 16 bits
+uint32_t PackTexCoord(float u, float v);
+
+// Packs shapes straight from the loader output, each buffer is allocated exactly once
+// Material ids outside of [0, material_count) are treated as -1
+PackedMesh PackMesh(const std::vector<tinyobj::shape_t> &shapes, size_t material_count, VertexFormat format);
+
+#endif // PPGSO_VERTEX_FORMAT_H
@@ -1,10 +1,17 @@
 #include "asteroid.h"
 #include "projectile.h"
 #include "explosion.h"
+#include "resource_cache.h"
 
 #include "object_frag.h"
 #include "object_vert.h"
 
+// Uniform handles of the shared shader, resolved once when the shader is created
+static struct {
+  Shader::Uniform<glm::mat4> modelMatrix;
+  Shader::Uniform<Texture> texture;
+} uniforms;
+
 Asteroid::Asteroid() {
   // Reset the age to 0
   age = 0;
@@ -16,9 +23,13 @@ Asteroid::Asteroid() {
   rotMomentum = glm::vec3(Rand(-PI, PI), Rand(-PI, PI), Rand(-PI, PI));
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-  if (!texture) texture = TexturePtr(new Texture{"asteroid.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "asteroid.obj"});
+  if (!shader) {
+    shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+    uniforms.modelMatrix = shader->GetUniform<glm::mat4>("ModelMatrix");
+    uniforms.texture = shader->GetUniform<Texture>("Texture");
+  }
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("asteroid.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("asteroid.obj");
 }
 
 Asteroid::~Asteroid() {
@@ -98,13 +109,9 @@ void Asteroid::Explode(Scene &scene, glm::vec3 explPosition, glm::vec3 explScale
 void Asteroid::Render(Scene &scene) {
   shader->Use();
 
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
   // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
+  shader->Set(uniforms.modelMatrix, modelMatrix);
+  shader->Set(uniforms.texture, texture);
   mesh->Render();
 }
 
@@ -1,6 +1,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "camera.h"
+#include "shader.h"
 
 #define PI 3.14159265358979323846f
 
@@ -20,3 +21,19 @@ Camera::~Camera() {
 void Camera::Update() {
   viewMatrix = glm::lookAt(position, position-back, up);
 }
+
+void Camera::Upload(float time) {
+  // Created on first use so cameras can be constructed before the OpenGL context
+  if (!uniformBuffer) uniformBuffer = UniformBufferPtr(new UniformBuffer{sizeof(UniformData)});
+
+  UniformData data;
+  data.viewMatrix = viewMatrix;
+  data.projectionMatrix = projectionMatrix;
+  data.viewProjectionMatrix = projectionMatrix * viewMatrix;
+  data.position = glm::vec4(position, 1.0f);
+  data.time = time;
+  data.padding[0] = data.padding[1] = data.padding[2] = 0.0f;
+
+  uniformBuffer->Update(&data);
+  uniformBuffer->Bind(UNIFORM_BLOCK_CAMERA);
+}
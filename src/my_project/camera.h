@@ -6,16 +6,22 @@
 #include <glm/detail/type_mat.hpp>
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/detail/type_vec3.hpp>
+#include <glm/detail/type_vec4.hpp>
+
+#include "uniform_buffer.h"
 
 // Simple camera object that keeps track of viewMatrix and projectionMatrix
 // the projectionMatrix is by default constructed as perspective projection
 // the viewMatrix is generated from up, position and back vectors on Update
+// Upload shares the matrices with all shaders through the "Camera" uniform block
 class Camera {
 public:
   Camera(float fow = 45.0f, float ratio = 1.0f, float near = 0.1f, float far = 10.0f);
   ~Camera();
 
   void Update();
+  // Uploads the camera uniform block and binds it to UNIFORM_BLOCK_CAMERA, call once per frame before rendering
+  void Upload(float time);
 
   glm::vec3 up;
   glm::vec3 position;
@@ -23,6 +29,19 @@ public:
 
   glm::mat4 viewMatrix;
   glm::mat4 projectionMatrix;
+
+private:
+  // Layout of the "Camera" uniform block in std140
+  struct UniformData {
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+    glm::mat4 viewProjectionMatrix;
+    glm::vec4 position;
+    float time;
+    float padding[3];
+  };
+
+  UniformBufferPtr uniformBuffer;
 };
 typedef std::shared_ptr< Camera > CameraPtr;
 
@@ -1,9 +1,18 @@
 #include "scene.h"
 #include "explosion.h"
+#include "resource_cache.h"
+#include "gl_state.h"
 
 #include "explosion_vert.h"
 #include "explosion_frag.h"
 
+// Uniform handles of the shared shader, resolved once when the shader is created
+static struct {
+  Shader::Uniform<GLfloat> transparency;
+  Shader::Uniform<glm::mat4> modelMatrix;
+  Shader::Uniform<Texture> texture;
+} uniforms;
+
 Explosion::Explosion() {
   // Set age
   maxAge = 0.2f;
@@ -15,9 +24,14 @@ Explosion::Explosion() {
   speed = glm::vec3(0.0f);
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{explosion_vert, explosion_frag});
-  if (!texture) texture = TexturePtr(new Texture{"explosion.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "asteroid.obj"});
+  if (!shader) {
+    shader = ResourceCache::Get().GetShader(explosion_vert, explosion_frag);
+    uniforms.transparency = shader->GetUniform<GLfloat>("Transparency");
+    uniforms.modelMatrix = shader->GetUniform<glm::mat4>("ModelMatrix");
+    uniforms.texture = shader->GetUniform<Texture>("Texture");
+  }
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("explosion.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("asteroid.obj");
 }
 
 Explosion::~Explosion() {
@@ -27,30 +41,26 @@ void Explosion::Render(Scene &scene) {
   shader->Use();
 
   // Transparency, interpolate from 1.0f -> 0.0f
-  shader->SetFloat(1.0f-age/maxAge, "Transparency");
-
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
+  shader->Set(uniforms.transparency, 1.0f-age/maxAge);
 
   // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
+  shader->Set(uniforms.modelMatrix, modelMatrix);
+  shader->Set(uniforms.texture, texture);
 
   // Disable depth testing
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().SetDepthTest(false);
 
   // Enable blending
-  glEnable(GL_BLEND);
+  GLState::Get().SetBlend(true);
   // Additive blending
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+  GLState::Get().SetBlendFunc(GL_SRC_ALPHA, GL_ONE);
 
   mesh->Render();
 
   // Disable blending
-  glDisable(GL_BLEND);
+  GLState::Get().SetBlend(false);
   // Enable depth test
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().SetDepthTest(true);
 }
 
 bool Explosion::Update(Scene &scene, float dt) {
@@ -6,9 +6,16 @@ in vec2 TexCoord;
 // This will be passed to the fragment shader
 out vec2 FragTexCoord;
 
+// Camera data shared by all programs, uploaded once per frame
+layout(std140) uniform Camera {
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+  mat4 ViewProjectionMatrix;
+  vec4 CameraPosition;
+  float Time;
+};
+
 // Matrices as program attributes
-uniform mat4 ProjectionMatrix;
-uniform mat4 ViewMatrix;
 uniform mat4 ModelMatrix;
 
 void main() {
@@ -16,5 +23,5 @@ void main() {
   FragTexCoord = TexCoord;
 
   // Calculate the final position on screen
-  gl_Position = ProjectionMatrix * ViewMatrix * ModelMatrix * vec4(Position, 1.0);
+  gl_Position = ViewProjectionMatrix * ModelMatrix * vec4(Position, 1.0);
 }
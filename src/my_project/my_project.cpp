@@ -14,17 +14,22 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <algorithm>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include "scene.h"
+#include "resource_cache.h"
+#include "gl_state.h"
 #include "camera.h"
 #include "generator.h"
 #include "player.h"
 #include "space.h"
 
 const unsigned int SIZE = 512;
+// Seconds per frame that may be spent uploading loaded assets
+const double UPLOAD_BUDGET = 0.002;
 
 Scene scene;
 
@@ -110,14 +115,17 @@ int main() {
 
     // Initialize OpenGL state
     // Enable Z-buffer
-    glEnable(GL_DEPTH_TEST);
+    GLState::Get().SetDepthTest(true);
     glDepthFunc(GL_LEQUAL);
 
     // Enable polygon culling
-    glEnable(GL_CULL_FACE);
+    GLState::Get().SetCullFace(true);
     glFrontFace(GL_CCW);
     glCullFace(GL_BACK);
 
+    // Start loading all assets in the background, objects get placeholders until their data is uploaded
+    ResourceCache::Get().PreloadManifest("my_project.manifest");
+
     InitializeScene();
 
     // Track time
@@ -138,11 +146,30 @@ int main() {
         scene.Update(dt);
         scene.Render();
 
+        // Upload assets finished by the background loader, limited so a frame never stalls
+        auto uploads = ResourceCache::Get().ProcessUploads(UPLOAD_BUDGET);
+        if (uploads.uploads > 0) {
+            std::cout << "Uploaded " << uploads.uploads << " assets, " << uploads.bytes / 1024 << " kB in "
+                      << uploads.time * 1000.0 << " ms, " << uploads.pending << " pending" << std::endl;
+        }
+
+        // Close the redundant state change statistics of this frame
+        GLState::Get().EndFrame();
+
         // Display result
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    // Report shared resources, then release the ones no object holds while the OpenGL context still exists
+    scene.objects.clear();
+    ResourceCache::Get().PrintStats(std::cout);
+    auto state = GLState::Get().GetTotalStats();
+    auto frames = std::max<size_t>(GLState::Get().GetFrameCount(), 1);
+    std::cout << "GL state changes per frame: " << state.issued / frames << " issued, "
+              << state.skipped / frames << " skipped" << std::endl;
+    ResourceCache::Get().EvictUnused();
+
     // Clean up
     glfwTerminate();
 
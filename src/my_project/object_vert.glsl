@@ -10,9 +10,16 @@ out vec2 FragTexCoord;
 // Normal to pass to the fragment shader
 out vec4 normal;
 
+// Camera data shared by all programs, uploaded once per frame
+layout(std140) uniform Camera {
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+  mat4 ViewProjectionMatrix;
+  vec4 CameraPosition;
+  float Time;
+};
+
 // Matrices as program attributes
-uniform mat4 ProjectionMatrix;
-uniform mat4 ViewMatrix;
 uniform mat4 ModelMatrix;
 
 void main() {
@@ -23,5 +30,5 @@ void main() {
   normal = normalize(ModelMatrix * vec4(Normal, 0.0f));
 
   // Calculate the final position on screen
-  gl_Position = ProjectionMatrix * ViewMatrix * ModelMatrix * vec4(Position, 1.0);
+  gl_Position = ViewProjectionMatrix * ModelMatrix * vec4(Position, 1.0);
 }
@@ -3,12 +3,19 @@
 #include "asteroid.h"
 #include "projectile.h"
 #include "explosion.h"
+#include "resource_cache.h"
 
 #include "object_frag.h"
 #include "object_vert.h"
 
 #include <GLFW/glfw3.h>
 
+// Uniform handles of the shared shader, resolved once when the shader is created
+static struct {
+  Shader::Uniform<glm::mat4> modelMatrix;
+  Shader::Uniform<Texture> texture;
+} uniforms;
+
 Player::Player() {
   // Reset fire delay
   fireDelay = 0;
@@ -21,9 +28,13 @@ Player::Player() {
   scale *= 3.0f;
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-  if (!texture) texture = TexturePtr(new Texture{"corsair.rgb", 256, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "corsair.obj"});
+  if (!shader) {
+    shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+    uniforms.modelMatrix = shader->GetUniform<glm::mat4>("ModelMatrix");
+    uniforms.texture = shader->GetUniform<Texture>("Texture");
+  }
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("corsair.rgb", 256, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("corsair.obj");
 }
 
 Player::~Player() {
@@ -85,13 +96,9 @@ bool Player::Update(Scene &scene, float dt) {
 void Player::Render(Scene &scene) {
   shader->Use();
 
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
   // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
+  shader->Set(uniforms.modelMatrix, modelMatrix);
+  shader->Set(uniforms.texture, texture);
   mesh->Render();
 }
 
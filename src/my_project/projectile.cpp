@@ -1,9 +1,16 @@
 #include "scene.h"
 #include "projectile.h"
+#include "resource_cache.h"
 
 #include "object_vert.h"
 #include "object_frag.h"
 
+// Uniform handles of the shared shader, resolved once when the shader is created
+static struct {
+  Shader::Uniform<glm::mat4> modelMatrix;
+  Shader::Uniform<Texture> texture;
+} uniforms;
+
 Projectile::Projectile() {
   // Initialize age to 0
   age = 0;
@@ -13,9 +20,13 @@ Projectile::Projectile() {
   rotMomentum = glm::vec3(0.0f, 0.0f, Rand(-PI/4.0f, PI/4.0f));
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{object_vert, object_frag});
-  if (!texture) texture = TexturePtr(new Texture{"missile.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "missile.obj"});
+  if (!shader) {
+    shader = ResourceCache::Get().GetShader(object_vert, object_frag);
+    uniforms.modelMatrix = shader->GetUniform<glm::mat4>("ModelMatrix");
+    uniforms.texture = shader->GetUniform<Texture>("Texture");
+  }
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("missile.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("missile.obj");
 }
 
 Projectile::~Projectile() {
@@ -42,13 +53,9 @@ bool Projectile::Update(Scene &scene, float dt) {
 void Projectile::Render(Scene &scene) {
   shader->Use();
 
-  // use camera
-  shader->SetMatrix(scene.camera->projectionMatrix, "ProjectionMatrix");
-  shader->SetMatrix(scene.camera->viewMatrix, "ViewMatrix");
-
   // render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
+  shader->Set(uniforms.modelMatrix, modelMatrix);
+  shader->Set(uniforms.texture, texture);
   mesh->Render();
 }
 
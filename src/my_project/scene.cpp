@@ -1,12 +1,14 @@
 #include "scene.h"
 
 Scene::Scene() {
+  time = 0;
 }
 
 Scene::~Scene() {
 }
 
 void Scene::Update(float time) {
+  this->time += time;
   camera->Update();
 
   // Use iterator to update all objects so we can remove while iterating
@@ -23,6 +25,9 @@ void Scene::Update(float time) {
 }
 
 void Scene::Render() {
+  // Camera matrices are shared by all objects, upload them once per frame
+  camera->Upload(time);
+
   // Simply render all objects
   for (auto obj : objects )
     obj->Render(*this);
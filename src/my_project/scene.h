@@ -21,6 +21,9 @@ class Scene {
     // Render all objects in scene
     void Render();
 
+    // Time since the scene was created in s, shaders get it through the camera uniform block
+    float time;
+
     CameraPtr camera;
     std::list< ObjectPtr > objects;
     std::map< int, int > keyboard;
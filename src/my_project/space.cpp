@@ -1,18 +1,31 @@
 #include "space.h"
 #include "scene.h"
+#include "resource_cache.h"
 
 #include "space_vert.h"
 #include "space_frag.h"
 
+// Uniform handles of the shared shader, resolved once when the shader is created
+static struct {
+  Shader::Uniform<GLfloat> offset;
+  Shader::Uniform<glm::mat4> modelMatrix;
+  Shader::Uniform<Texture> texture;
+} uniforms;
+
 Space::Space() {
   offset = 0;
   // Z of 1 means back as there is no perspective projection applied during render
   position.z = 1;
 
   // Initialize static resources if needed
-  if (!shader) shader = ShaderPtr(new Shader{space_vert, space_frag});
-  if (!texture) texture = TexturePtr(new Texture{"stars.rgb", 512, 512});
-  if (!mesh) mesh = MeshPtr(new Mesh{shader, "quad.obj"});
+  if (!shader) {
+    shader = ResourceCache::Get().GetShader(space_vert, space_frag);
+    uniforms.offset = shader->GetUniform<GLfloat>("Offset");
+    uniforms.modelMatrix = shader->GetUniform<glm::mat4>("ModelMatrix");
+    uniforms.texture = shader->GetUniform<Texture>("Texture");
+  }
+  if (!texture) texture = ResourceCache::Get().GetTextureAsync("stars.rgb", 512, 512);
+  if (!mesh) mesh = ResourceCache::Get().GetMeshAsync("quad.obj");
 }
 
 Space::~Space() {
@@ -31,11 +44,11 @@ void Space::Render(Scene &scene) {
   shader->Use();
 
   // Pass UV mapping offset to the shader
-  shader->SetFloat(offset, "Offset");
+  shader->Set(uniforms.offset, offset);
 
   // Render mesh
-  shader->SetMatrix(modelMatrix, "ModelMatrix");
-  shader->SetTexture(texture, "Texture");
+  shader->Set(uniforms.modelMatrix, modelMatrix);
+  shader->Set(uniforms.texture, texture);
   mesh->Render();
 }
 